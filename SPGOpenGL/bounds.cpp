@@ -0,0 +1,100 @@
+#include "bounds.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // position(i) = pozitia celui de-al i-lea punct
+    template <typename Position>
+    Bounds computeBoundsOf(size_t count, const Position& position) {
+        Bounds bounds;
+        if (count == 0) return bounds;
+
+        glm::vec3 lo = position(0), hi = lo;
+        // Extremele pe fiecare axa, pentru sfera Ritter
+        glm::vec3 minPoint[3] = { lo, lo, lo }, maxPoint[3] = { lo, lo, lo };
+        for (size_t i = 0; i < count; i++) {
+            glm::vec3 p = position(i);
+            lo = glm::min(lo, p);
+            hi = glm::max(hi, p);
+            for (int axis = 0; axis < 3; axis++) {
+                if (p[axis] < minPoint[axis][axis]) minPoint[axis] = p;
+                if (p[axis] > maxPoint[axis][axis]) maxPoint[axis] = p;
+            }
+        }
+        bounds.box.min = lo;
+        bounds.box.max = hi;
+
+        // Sfera din centrul AABB-ului
+        BoundingSphere boxSphere;
+        boxSphere.center = bounds.box.center();
+        for (size_t i = 0; i < count; i++) {
+            boxSphere.radius = std::max(boxSphere.radius, glm::length(position(i) - boxSphere.center));
+        }
+
+        // Ritter: porneste de la cea mai departata pereche de extreme si creste sfera pentru punctele ramase afara
+        int widest = 0;
+        for (int axis = 1; axis < 3; axis++) {
+            if (glm::length(maxPoint[axis] - minPoint[axis]) > glm::length(maxPoint[widest] - minPoint[widest])) widest = axis;
+        }
+        BoundingSphere ritter;
+        ritter.center = (minPoint[widest] + maxPoint[widest]) * 0.5f;
+        ritter.radius = glm::length(maxPoint[widest] - minPoint[widest]) * 0.5f;
+        for (size_t i = 0; i < count; i++) {
+            glm::vec3 p = position(i);
+            float distance = glm::length(p - ritter.center);
+            if (distance > ritter.radius) {
+                float radius = (ritter.radius + distance) * 0.5f;
+                ritter.center += (p - ritter.center) * ((radius - ritter.radius) / distance);
+                ritter.radius = radius;
+            }
+        }
+
+        bounds.sphere = ritter.radius < boxSphere.radius ? ritter : boxSphere;
+        return bounds;
+    }
+}
+
+Bounds computeBounds(const float* vertexData, size_t stride, size_t vertexCount) {
+    return computeBoundsOf(vertexCount, [&](size_t i) {
+        const float* p = vertexData + i * stride;
+        return glm::vec3(p[0], p[1], p[2]);
+    });
+}
+
+Bounds computeBounds(const float* vertexData, size_t stride, const GLuint* indices, size_t indexCount) {
+    return computeBoundsOf(indexCount, [&](size_t i) {
+        const float* p = vertexData + (size_t)indices[i] * stride;
+        return glm::vec3(p[0], p[1], p[2]);
+    });
+}
+
+Aabb transformAabb(const Aabb& box, const glm::mat4& matrix) {
+    glm::vec3 center = glm::vec3(matrix * glm::vec4(box.center(), 1.0f));
+    glm::vec3 extent = box.extent();
+    glm::vec3 worldExtent(0.0f);
+    for (int column = 0; column < 3; column++) {
+        worldExtent += glm::abs(glm::vec3(matrix[column])) * extent[column];
+    }
+    return { center - worldExtent, center + worldExtent };
+}
+
+BoundingSphere transformSphere(const BoundingSphere& sphere, const glm::mat4& matrix) {
+    float scale = std::max({ glm::length(glm::vec3(matrix[0])), glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2])) });
+    return { glm::vec3(matrix * glm::vec4(sphere.center, 1.0f)), sphere.radius * scale };
+}
+
+Bounds transformBounds(const Bounds& bounds, const glm::mat4& matrix) {
+    return { transformAabb(bounds.box, matrix), transformSphere(bounds.sphere, matrix) };
+}
+
+bool intersects(const Aabb& a, const Aabb& b) {
+    return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+        a.min.y <= b.max.y && a.max.y >= b.min.y &&
+        a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+bool contains(const Aabb& box, const glm::vec3& point) {
+    return point.x >= box.min.x && point.x <= box.max.x &&
+        point.y >= box.min.y && point.y <= box.max.y &&
+        point.z >= box.min.z && point.z <= box.max.z;
+}
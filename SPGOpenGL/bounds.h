@@ -0,0 +1,41 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+
+// Volume de incadrare pentru mesh-uri si submesh-uri, in spatiul modelului.
+// Pentru VertexLayout::Compact sunt tot in spatiul original (fara Mesh::positionTransform),
+// deci se transforma doar cu matricea model.
+
+struct Aabb {
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    glm::vec3 extent() const { return (max - min) * 0.5f; } // jumatate din latura pe fiecare axa
+};
+
+struct BoundingSphere {
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+struct Bounds {
+    Aabb box;
+    BoundingSphere sphere;
+};
+
+// Vertecsii au stride floats (pozitia pe primele 3). Cu indices, doar vertecsii folositi de ei.
+// Sfera e cea mai mica dintre sfera Ritter si sfera din centrul AABB-ului.
+Bounds computeBounds(const float* vertexData, size_t stride, size_t vertexCount);
+Bounds computeBounds(const float* vertexData, size_t stride, const GLuint* indices, size_t indexCount);
+
+// In spatiul lumii (sau al oricarei matrice afine): AABB-ul care contine cutia transformata
+// (Arvo) si sfera scalata cu cea mai mare scalare a matricei
+Aabb transformAabb(const Aabb& box, const glm::mat4& matrix);
+BoundingSphere transformSphere(const BoundingSphere& sphere, const glm::mat4& matrix);
+Bounds transformBounds(const Bounds& bounds, const glm::mat4& matrix);
+
+bool intersects(const Aabb& a, const Aabb& b);
+bool contains(const Aabb& box, const glm::vec3& point);
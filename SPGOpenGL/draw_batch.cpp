@@ -0,0 +1,265 @@
+#include "draw_batch.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <vector>
+
+namespace {
+    // Comenzile care se pot trimite cu acelasi apel MDI
+    struct BatchGroup {
+        GLenum indexType;
+        bool polygonOffset;
+        GLint diffuseArray, normalArray; // in DrawBatch::arrays
+        std::vector<DrawElementsIndirectCommand> commands;
+        std::vector<GLuint> drawIndices; // indexul in drawData pentru fiecare comanda (citit cu gl_DrawIDARB)
+    };
+
+    // Texturile cu acelasi format intern, aceleasi dimensiuni si acelasi numar de niveluri, ca layer-e
+    struct BatchTextureArray {
+        GLuint texture = 0;
+        GLenum internalFormat = 0;
+        GLsizei width = 0, height = 0, levels = 0;
+        GLsizei layerCount = 0, capacity = 0;
+    };
+
+    struct DrawBatch {
+        GLuint drawDataBuffer = 0, drawIndexBuffer = 0, commandBuffer = 0;
+        std::vector<BatchDrawData> drawData;
+        std::vector<std::pair<GLint, GLint>> drawArrays; // array-ul difuz si cel de normal map-uri al fiecarui desen
+        std::vector<BatchGroup> groups;
+        // Reutilizate la urcare ca sa nu se realoce in fiecare cadru
+        std::vector<DrawElementsIndirectCommand> commands;
+        std::vector<GLuint> drawIndices;
+
+        std::vector<BatchTextureArray> arrays;
+        std::map<GLuint, BatchTextureSlot> slots;
+    };
+    DrawBatch batch;
+
+    // Array nou cu capacity layer-e; primele copyLayers sunt copiate din old (la realocare)
+    GLuint createTextureArray(const BatchTextureArray& format, GLsizei capacity, GLuint old, GLsizei copyLayers) {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, format.levels, format.internalFormat, format.width, format.height, capacity);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, format.levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        GLsizei width = format.width, height = format.height;
+        for (GLint level = 0; level < format.levels && copyLayers > 0; level++) {
+            glCopyImageSubData(old, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                width, height, copyLayers);
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+        return texture;
+    }
+
+    // Un array cu formatul dat si loc pentru inca depth layer-e (realocat sau nou)
+    GLint reserveTextureArray(const BatchTextureArray& format, GLsizei depth) {
+        GLint maxLayers = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+        for (size_t i = 0; i < batch.arrays.size(); i++) {
+            BatchTextureArray& array = batch.arrays[i];
+            if (array.internalFormat != format.internalFormat || array.width != format.width ||
+                array.height != format.height || array.levels != format.levels ||
+                array.layerCount + depth > maxLayers) {
+                continue;
+            }
+            if (array.layerCount + depth > array.capacity) {
+                GLsizei capacity = std::min(std::max(array.capacity * 2, array.layerCount + depth), (GLsizei)maxLayers);
+                GLuint texture = createTextureArray(array, capacity, array.texture, array.layerCount);
+                glDeleteTextures(1, &array.texture);
+                array.texture = texture;
+                array.capacity = capacity;
+            }
+            return (GLint)i;
+        }
+
+        BatchTextureArray array = format;
+        array.capacity = std::max(BATCH_INITIAL_TEXTURE_LAYERS, depth);
+        array.texture = createTextureArray(array, array.capacity, 0, 0);
+        batch.arrays.push_back(array);
+        return (GLint)batch.arrays.size() - 1;
+    }
+
+    // Toate nivelurile texturii (un layer pentru GL_TEXTURE_2D, toate straturile pentru GL_TEXTURE_2D_ARRAY),
+    // copiate pe GPU asa cum sunt, inclusiv blocurile comprimate
+    bool addBatchLayers(GLenum target, GLuint texture) {
+        if (texture == 0) return false;
+        if (batch.slots.count(texture)) return true;
+
+        BatchTextureArray format;
+        GLint width = 0, height = 0, depth = 1, internalFormat = 0, maxLevel = 0;
+        glBindTexture(target, texture);
+        glGetTexLevelParameteriv(target, 0, GL_TEXTURE_WIDTH, &width);
+        glGetTexLevelParameteriv(target, 0, GL_TEXTURE_HEIGHT, &height);
+        if (target == GL_TEXTURE_2D_ARRAY) glGetTexLevelParameteriv(target, 0, GL_TEXTURE_DEPTH, &depth);
+        glGetTexLevelParameteriv(target, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+        glGetTexParameteriv(target, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+        glBindTexture(target, 0);
+        if (width <= 0 || height <= 0 || internalFormat == 0) {
+            std::cerr << "Draw batch: texture " << texture << " has no image, not added" << std::endl;
+            return false;
+        }
+
+        // GL_TEXTURE_MAX_LEVEL e setat de uploadTexture la ultimul nivel urcat; fara el (1000) doar nivelul 0
+        GLsizei levels = 1;
+        for (GLsizei size = std::max(width, height); size > 1 && levels <= maxLevel; size /= 2) levels++;
+        format.internalFormat = (GLenum)internalFormat;
+        format.width = width;
+        format.height = height;
+        format.levels = levels;
+
+        GLint arrayIndex = reserveTextureArray(format, depth);
+        BatchTextureArray& array = batch.arrays[arrayIndex];
+        for (GLint level = 0; level < levels; level++) {
+            glCopyImageSubData(texture, target, level, 0, 0, 0, array.texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, array.layerCount,
+                std::max(1, width >> level), std::max(1, height >> level), depth);
+        }
+        batch.slots[texture] = { arrayIndex, array.layerCount };
+        array.layerCount += depth;
+        return true;
+    }
+
+    BatchGroup& groupFor(GLenum indexType, bool polygonOffset, GLint diffuseArray, GLint normalArray) {
+        for (BatchGroup& group : batch.groups) {
+            if (group.indexType == indexType && group.polygonOffset == polygonOffset &&
+                group.diffuseArray == diffuseArray && group.normalArray == normalArray) {
+                return group;
+            }
+        }
+        batch.groups.push_back({ indexType, polygonOffset, diffuseArray, normalArray, {}, {} });
+        return batch.groups.back();
+    }
+
+    template <typename T>
+    void uploadBuffer(GLenum target, GLuint buffer, const std::vector<T>& data) {
+        glBindBuffer(target, buffer);
+        // Orfan in fiecare cadru: driverul nu asteapta dupa desenele cadrului anterior
+        glBufferData(target, data.size() * sizeof(T), data.data(), GL_STREAM_DRAW);
+    }
+}
+
+bool drawBatchSupported() {
+    return GLEW_VERSION_4_3 && GLEW_ARB_shader_draw_parameters;
+}
+
+bool addBatchTexture(GLuint texture) {
+    return addBatchLayers(GL_TEXTURE_2D, texture);
+}
+
+bool addBatchTextureArray(GLuint textureArray) {
+    return addBatchLayers(GL_TEXTURE_2D_ARRAY, textureArray);
+}
+
+BatchTextureSlot batchTextureSlot(GLuint texture) {
+    auto it = batch.slots.find(texture);
+    return it != batch.slots.end() ? it->second : BatchTextureSlot();
+}
+
+void releaseDrawBatchTextures() {
+    for (BatchTextureArray& array : batch.arrays) glDeleteTextures(1, &array.texture);
+    batch.arrays.clear();
+    batch.slots.clear();
+    // Grupurile retin indici in arrays
+    batch.groups.clear();
+}
+
+void beginDrawBatch() {
+    batch.drawData.clear();
+    batch.drawArrays.clear();
+    for (BatchGroup& group : batch.groups) {
+        group.commands.clear();
+        group.drawIndices.clear();
+    }
+}
+
+GLuint addBatchDrawData(const BatchDrawData& data, const BatchTextureSlot& diffuse, const BatchTextureSlot& normal) {
+    batch.drawData.push_back(data);
+    batch.drawData.back().diffuseLayer = diffuse.layer;
+    batch.drawData.back().normalLayer = normal.layer;
+    batch.drawArrays.push_back({ diffuse.array, normal.array });
+    return (GLuint)batch.drawData.size() - 1;
+}
+
+void addBatchRange(GLenum indexType, GLsizei count, const void* indexOffset, GLint baseVertex, GLuint drawData,
+    bool polygonOffset) {
+    if (count <= 0) return;
+    BatchGroup& group = groupFor(indexType, polygonOffset, batch.drawArrays[drawData].first, batch.drawArrays[drawData].second);
+    // In comanda, inceputul e in indici, nu in octeti
+    GLuint firstIndex = (GLuint)((size_t)indexOffset / indexSize(indexType));
+    group.commands.push_back({ (GLuint)count, 1, firstIndex, baseVertex, 0 });
+    group.drawIndices.push_back(drawData);
+}
+
+void addBatchRanges(const Mesh& mesh, const MeshletDrawList& ranges, GLuint drawData, bool polygonOffset) {
+    for (size_t i = 0; i < ranges.counts.size(); i++) {
+        addBatchRange(mesh.indexType, ranges.counts[i], ranges.offsets[i], ranges.baseVertices[i], drawData, polygonOffset);
+    }
+}
+
+size_t submitDrawBatch(GLuint program) {
+    if (batch.drawData.empty()) return 0;
+    if (!batch.commandBuffer) {
+        glGenBuffers(1, &batch.drawDataBuffer);
+        glGenBuffers(1, &batch.drawIndexBuffer);
+        glGenBuffers(1, &batch.commandBuffer);
+    }
+
+    // Toate grupurile intr-un singur buffer de comenzi; fiecare apel MDI porneste de la offset-ul grupului
+    batch.commands.clear();
+    batch.drawIndices.clear();
+    for (const BatchGroup& group : batch.groups) {
+        batch.commands.insert(batch.commands.end(), group.commands.begin(), group.commands.end());
+        batch.drawIndices.insert(batch.drawIndices.end(), group.drawIndices.begin(), group.drawIndices.end());
+    }
+    if (batch.commands.empty()) return 0;
+
+    uploadBuffer(GL_SHADER_STORAGE_BUFFER, batch.drawDataBuffer, batch.drawData);
+    uploadBuffer(GL_SHADER_STORAGE_BUFFER, batch.drawIndexBuffer, batch.drawIndices);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    uploadBuffer(GL_DRAW_INDIRECT_BUFFER, batch.commandBuffer, batch.commands);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, batch.drawDataBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, batch.drawIndexBuffer);
+
+    glUniform1i(glGetUniformLocation(program, "diffuseLayers"), 0);
+    glUniform1i(glGetUniformLocation(program, "normalLayers"), 1);
+    GLint commandOffsetLocation = glGetUniformLocation(program, "drawCommandOffset");
+
+    size_t calls = 0, offset = 0;
+    for (const BatchGroup& group : batch.groups) {
+        if (group.commands.empty()) continue;
+        if (group.diffuseArray < 0 || group.normalArray < 0) {
+            offset += group.commands.size();
+            continue;
+        }
+        // Valorile offset-ului sunt cele setate de apelant cu glPolygonOffset
+        if (group.polygonOffset) glEnable(GL_POLYGON_OFFSET_FILL);
+        else glDisable(GL_POLYGON_OFFSET_FILL);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, batch.arrays[group.diffuseArray].texture);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, batch.arrays[group.normalArray].texture);
+        glUniform1i(commandOffsetLocation, (GLint)offset);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, group.indexType, (const void*)(offset * sizeof(DrawElementsIndirectCommand)),
+            (GLsizei)group.commands.size(), 0);
+        offset += group.commands.size();
+        calls++;
+    }
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return calls;
+}
+
+size_t batchCommandCount() {
+    size_t count = 0;
+    for (const BatchGroup& group : batch.groups) count += group.commands.size();
+    return count;
+}
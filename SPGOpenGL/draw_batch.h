@@ -0,0 +1,72 @@
+#pragma once
+
+#include "obj_loader.hpp"
+#include "meshlet.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// Desenarea tuturor obiectelor opace din arena de geometrie cu glMultiDrawElementsIndirect.
+// Datele per desen (matrice, layer-e de textura, parametri) stau intr-un SSBO; vertex.vert/fragment.frag
+// compilate cu BATCHED le citesc prin gl_DrawIDARB. Texturile sunt copiate la incarcare, cu glCopyImageSubData,
+// ca layer-e in GL_TEXTURE_2D_ARRAY-uri grupate dupa format, dimensiune si numar de mipmap-uri: fara redimensionare,
+// fara decomprimare. Intre desenele unui apel nu se schimba nici uniform-uri, nici texturi.
+// Un apel MDI pentru fiecare combinatie (tip de index, polygon offset, array difuz, array de normal map-uri) din cadru.
+// Necesita GL 4.3 si ARB_shader_draw_parameters (vezi drawBatchSupported).
+
+// Layer-e alocate la crearea unui array; cand se umple, e realocat de doua ori mai mare
+const GLsizei BATCH_INITIAL_TEXTURE_LAYERS = 4;
+
+// Ca DrawData din vertex.vert / fragment.frag (std430, 144 de octeti)
+struct BatchDrawData {
+    glm::mat4 modelMatrix;  // include Mesh::positionTransform
+    glm::mat4 normalMatrix;
+    GLint diffuseLayer;     // completate de addBatchDrawData din slot-uri
+    GLint normalLayer;
+    float normalMapStrength;
+    float lightIntensityOffset; // adunat la lightIntensity (camera e putin mai luminata decat obiectele)
+};
+
+// Comanda citita de glMultiDrawElementsIndirect din GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+bool drawBatchSupported();
+
+// Unde a fost copiata o textura: array-ul batch-ului si primul layer; array = -1 daca textura nu e in batch
+struct BatchTextureSlot {
+    GLint array = -1;
+    GLint layer = -1;
+};
+
+// Copiaza textura in batch; se apeleaza la incarcare, nu in timpul cadrului. false pentru 0 sau un format necunoscut.
+bool addBatchTexture(GLuint texture);
+// Toate straturile unui GL_TEXTURE_2D_ARRAY, in layer-e consecutive; stratul i e la slot.layer + i
+// (de ex. camera: cate un BatchDrawData pe strat, in acelasi apel MDI)
+bool addBatchTextureArray(GLuint textureArray);
+// Doar cauta; o textura neadaugata intoarce un slot invalid, iar desenul ei trebuie facut in afara batch-ului
+BatchTextureSlot batchTextureSlot(GLuint texture);
+// Sterge array-urile si slot-urile, ca o textura sa nu ramana de doua ori in memorie cat timp batch-ul e oprit;
+// texturile originale nu sunt atinse si pot fi adaugate din nou
+void releaseDrawBatchTextures();
+
+// Golit la inceputul fiecarui cadru
+void beginDrawBatch();
+// Inregistreaza datele unui desen; layer-ele vin din slot-uri, care trebuie sa fie valide.
+// Indexul intors e folosit de intervalele care le impart.
+GLuint addBatchDrawData(const BatchDrawData& data, const BatchTextureSlot& diffuse, const BatchTextureSlot& normal);
+// Un interval de indici din arena
+void addBatchRange(GLenum indexType, GLsizei count, const void* indexOffset, GLint baseVertex, GLuint drawData,
+    bool polygonOffset = false);
+// Toate intervalele unei liste produse de cullSubMesh / cullMeshLod
+void addBatchRanges(const Mesh& mesh, const MeshletDrawList& ranges, GLuint drawData, bool polygonOffset = false);
+
+// Urca comenzile si datele si deseneaza; program e deja activ, cu uniform-urile comune setate,
+// iar VAO-ul arenei e legat. Intoarce numarul de apeluri MDI.
+size_t submitDrawBatch(GLuint program);
+
+size_t batchCommandCount();
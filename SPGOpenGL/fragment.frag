@@ -8,14 +8,35 @@ in VS_OUT {
     vec2 TexCoords;
 } fs_in;
 
+#ifdef BATCHED
+struct DrawData {
+    mat4 modelMatrix;
+    mat4 normalMatrix;
+    ivec2 layers; // in diffuseLayers, normalLayers
+    float normalMapStrength;
+    float lightIntensityOffset;
+};
+layout(std430, binding = 0) readonly buffer DrawDataBuffer { DrawData draws[]; };
+flat in int drawIndex;
+// Array-urile grupului desenat (draw_batch.h); toate desenele unui apel MDI folosesc aceleasi doua
+uniform sampler2DArray diffuseLayers;
+uniform sampler2DArray normalLayers;
+#elif defined(LAYERED)
+// Camera: difuzele si normal map-urile fetelor in doua array-uri; textureLayer e setat pentru fiecare interval de fete
+uniform sampler2DArray albedoLayers;
+uniform int textureLayer;
+uniform sampler2DArray normalLayers;
+uniform float normalMapStrength;
+#else
 uniform sampler2D texture1;
 uniform sampler2D texture2;
+uniform float normalMapStrength;
+#endif
 
 uniform vec3 viewPos;
 uniform int numLights;
 uniform vec3 lightPositions[6];
 uniform float lightIntensity;
-uniform float normalMapStrength;
 
 uniform vec3 sunPosition;
 uniform float sunIntensity;
@@ -90,7 +111,7 @@ float calculateSunShadow(vec3 fragPos, vec3 sunPos, vec3 normal, float timeOfDay
     return shadowFactor;
 }
 
-vec3 calculateLighting(vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo) {
+vec3 calculateLighting(vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo, float intensity) {
     vec3 ambient = vec3(0.05, 0.05, 0.08);
     vec3 result = ambient * albedo;
    
@@ -103,11 +124,11 @@ vec3 calculateLighting(vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo) {
         float shadowFactor = calculateObjectShadow(fragPos, lightPositions[i], normal);
         
         float diff = max(dot(normal, lightDir), 0.0);
-        vec3 diffuse = diff * vec3(1.0, 0.9, 0.7) * lightIntensity;
+        vec3 diffuse = diff * vec3(1.0, 0.9, 0.7) * intensity;
         
         vec3 reflectDir = reflect(-lightDir, normal);
         float spec = pow(max(dot(viewDir, reflectDir), 0.0), 64.0);
-        vec3 specular = spec * vec3(1.0, 0.9, 0.7) * lightIntensity * 0.5;
+        vec3 specular = spec * vec3(1.0, 0.9, 0.7) * intensity * 0.5;
         
         result += (diffuse + specular) * attenuation * albedo * shadowFactor;
     }
@@ -153,23 +174,33 @@ vec3 calculateLighting(vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo) {
 }
 
 void main() {
+#ifdef BATCHED
+    DrawData draw = draws[drawIndex];
+    vec3 albedo = texture(diffuseLayers, vec3(fs_in.TexCoords, draw.layers.x)).rgb;
+    vec3 normalMap = texture(normalLayers, vec3(fs_in.TexCoords, draw.layers.y)).rgb * 2.0 - 1.0;
+    float strength = draw.normalMapStrength;
+    float intensity = lightIntensity + draw.lightIntensityOffset;
+#elif defined(LAYERED)
+    vec3 albedo = texture(albedoLayers, vec3(fs_in.TexCoords, textureLayer)).rgb;
+    vec3 normalMap = texture(normalLayers, vec3(fs_in.TexCoords, textureLayer)).rgb * 2.0 - 1.0;
+    float strength = normalMapStrength;
+    float intensity = lightIntensity;
+#else
     vec3 albedo = texture(texture1, fs_in.TexCoords).rgb;
-    
     vec3 normalMap = texture(texture2, fs_in.TexCoords).rgb * 2.0 - 1.0;
-    normalMap.xy *= min(normalMapStrength, 0.8);
-    
-    vec3 T = normalize(fs_in.Tangent);
-    vec3 B = normalize(fs_in.Bitangent);
-    vec3 N = normalize(fs_in.Normal);
+    float strength = normalMapStrength;
+    float intensity = lightIntensity;
+#endif
+    // Normal map-urile BC5 au doar x si y; z se reface din lungimea unitara
+    normalMap.z = sqrt(max(1.0 - dot(normalMap.xy, normalMap.xy), 0.0));
+    normalMap.xy *= min(strength, 0.8);
     
-    T = normalize(T - dot(T, N) * N);
-    B = normalize(cross(N, T));
-    mat3 TBN = mat3(T, B, N);
+    mat3 TBN = mat3(normalize(fs_in.Tangent), normalize(fs_in.Bitangent), normalize(fs_in.Normal));
     
     vec3 normal = normalize(TBN * normalMap);
     vec3 viewDir = normalize(viewPos - fs_in.FragPos);
     
-    vec3 color = calculateLighting(normal, fs_in.FragPos, viewDir, albedo);
+    vec3 color = calculateLighting(normal, fs_in.FragPos, viewDir, albedo, intensity);
     
     color = color / (color + vec3(0.8));
     color = pow(color, vec3(1.0/2.2));
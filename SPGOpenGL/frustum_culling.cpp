@@ -0,0 +1,137 @@
+#include "frustum_culling.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define FRUSTUM_CULLING_SSE
+#include <immintrin.h>
+#endif
+
+namespace {
+    bool boundsVisible(const Frustum& frustum, const glm::vec3& center, float radius, const glm::vec3& lo, const glm::vec3& hi) {
+        for (const glm::vec4& plane : frustum.planes) {
+            glm::vec3 normal(plane);
+            if (glm::dot(normal, center) + plane.w < -radius) return false;
+            // Coltul AABB-ului cel mai departat in directia normalei
+            glm::vec3 farthest(plane.x >= 0.0f ? hi.x : lo.x, plane.y >= 0.0f ? hi.y : lo.y, plane.z >= 0.0f ? hi.z : lo.z);
+            if (glm::dot(normal, farthest) + plane.w < 0.0f) return false;
+        }
+        return true;
+    }
+
+    bool volumeVisible(const Frustum& frustum, const CullingVolumes& volumes, size_t i) {
+        return boundsVisible(frustum, glm::vec3(volumes.centerX[i], volumes.centerY[i], volumes.centerZ[i]), volumes.radius[i],
+            glm::vec3(volumes.minX[i], volumes.minY[i], volumes.minZ[i]), glm::vec3(volumes.maxX[i], volumes.maxY[i], volumes.maxZ[i]));
+    }
+
+#ifdef FRUSTUM_CULLING_SSE
+    // Bitul k = volumul i + k e vizibil
+    int visibleMask4(const Frustum& frustum, const CullingVolumes& volumes, size_t i) {
+        __m128 cx = _mm_loadu_ps(&volumes.centerX[i]), cy = _mm_loadu_ps(&volumes.centerY[i]), cz = _mm_loadu_ps(&volumes.centerZ[i]);
+        __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&volumes.radius[i]));
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const glm::vec4& plane : frustum.planes) {
+            __m128 nx = _mm_set1_ps(plane.x), ny = _mm_set1_ps(plane.y), nz = _mm_set1_ps(plane.z), nw = _mm_set1_ps(plane.w);
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_add_ps(_mm_mul_ps(nz, cz), nw));
+            visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, negativeRadius));
+
+            __m128 px = _mm_loadu_ps(plane.x >= 0.0f ? &volumes.maxX[i] : &volumes.minX[i]);
+            __m128 py = _mm_loadu_ps(plane.y >= 0.0f ? &volumes.maxY[i] : &volumes.minY[i]);
+            __m128 pz = _mm_loadu_ps(plane.z >= 0.0f ? &volumes.maxZ[i] : &volumes.minZ[i]);
+            __m128 farthest = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, px), _mm_mul_ps(ny, py)), _mm_add_ps(_mm_mul_ps(nz, pz), nw));
+            visible = _mm_and_ps(visible, _mm_cmpge_ps(farthest, _mm_setzero_ps()));
+        }
+        return _mm_movemask_ps(visible);
+    }
+#endif
+
+#ifdef __AVX__
+    int visibleMask8(const Frustum& frustum, const CullingVolumes& volumes, size_t i) {
+        __m256 cx = _mm256_loadu_ps(&volumes.centerX[i]), cy = _mm256_loadu_ps(&volumes.centerY[i]), cz = _mm256_loadu_ps(&volumes.centerZ[i]);
+        __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&volumes.radius[i]));
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const glm::vec4& plane : frustum.planes) {
+            __m256 nx = _mm256_set1_ps(plane.x), ny = _mm256_set1_ps(plane.y), nz = _mm256_set1_ps(plane.z), nw = _mm256_set1_ps(plane.w);
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, cx), _mm256_mul_ps(ny, cy)), _mm256_add_ps(_mm256_mul_ps(nz, cz), nw));
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+
+            __m256 px = _mm256_loadu_ps(plane.x >= 0.0f ? &volumes.maxX[i] : &volumes.minX[i]);
+            __m256 py = _mm256_loadu_ps(plane.y >= 0.0f ? &volumes.maxY[i] : &volumes.minY[i]);
+            __m256 pz = _mm256_loadu_ps(plane.z >= 0.0f ? &volumes.maxZ[i] : &volumes.minZ[i]);
+            __m256 farthest = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, px), _mm256_mul_ps(ny, py)), _mm256_add_ps(_mm256_mul_ps(nz, pz), nw));
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(farthest, _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        return _mm256_movemask_ps(visible);
+    }
+#endif
+
+    void appendMask(int mask, size_t first, std::vector<uint32_t>& visible) {
+        while (mask) {
+            int bit = 0;
+            while (!(mask & (1 << bit))) bit++;
+            visible.push_back((uint32_t)(first + bit));
+            mask &= mask - 1;
+        }
+    }
+}
+
+Frustum extractFrustum(const glm::mat4& viewProjection) {
+    Frustum frustum;
+    for (int i = 0; i < 3; i++) {
+        frustum.planes[i * 2] = glm::vec4(viewProjection[0][3] + viewProjection[0][i], viewProjection[1][3] + viewProjection[1][i],
+            viewProjection[2][3] + viewProjection[2][i], viewProjection[3][3] + viewProjection[3][i]);
+        frustum.planes[i * 2 + 1] = glm::vec4(viewProjection[0][3] - viewProjection[0][i], viewProjection[1][3] - viewProjection[1][i],
+            viewProjection[2][3] - viewProjection[2][i], viewProjection[3][3] - viewProjection[3][i]);
+    }
+    for (glm::vec4& plane : frustum.planes) plane /= glm::length(glm::vec3(plane));
+    return frustum;
+}
+
+void CullingVolumes::clear() {
+    for (std::vector<float>* component : { &centerX, &centerY, &centerZ, &radius, &minX, &minY, &minZ, &maxX, &maxY, &maxZ }) {
+        component->clear();
+    }
+}
+
+uint32_t CullingVolumes::add(const Bounds& worldBounds) {
+    centerX.push_back(worldBounds.sphere.center.x);
+    centerY.push_back(worldBounds.sphere.center.y);
+    centerZ.push_back(worldBounds.sphere.center.z);
+    radius.push_back(worldBounds.sphere.radius);
+    minX.push_back(worldBounds.box.min.x);
+    minY.push_back(worldBounds.box.min.y);
+    minZ.push_back(worldBounds.box.min.z);
+    maxX.push_back(worldBounds.box.max.x);
+    maxY.push_back(worldBounds.box.max.y);
+    maxZ.push_back(worldBounds.box.max.z);
+    return (uint32_t)radius.size() - 1;
+}
+
+void cullVolumes(const Frustum& frustum, const CullingVolumes& volumes, std::vector<uint32_t>& visible) {
+    visible.clear();
+    size_t count = volumes.size(), i = 0;
+#ifdef __AVX__
+    for (; i + 8 <= count; i += 8) appendMask(visibleMask8(frustum, volumes, i), i, visible);
+#endif
+#ifdef FRUSTUM_CULLING_SSE
+    for (; i + 4 <= count; i += 4) appendMask(visibleMask4(frustum, volumes, i), i, visible);
+#endif
+    for (; i < count; i++) {
+        if (volumeVisible(frustum, volumes, i)) visible.push_back((uint32_t)i);
+    }
+}
+
+bool isVisible(const Frustum& frustum, const Bounds& worldBounds) {
+    return boundsVisible(frustum, worldBounds.sphere.center, worldBounds.sphere.radius, worldBounds.box.min, worldBounds.box.max);
+}
+
+FrustumOverlap classifyAabb(const Frustum& frustum, const Aabb& box) {
+    FrustumOverlap result = FrustumOverlap::Inside;
+    for (const glm::vec4& plane : frustum.planes) {
+        glm::vec3 normal(plane);
+        glm::vec3 farthest(plane.x >= 0.0f ? box.max.x : box.min.x, plane.y >= 0.0f ? box.max.y : box.min.y, plane.z >= 0.0f ? box.max.z : box.min.z);
+        if (glm::dot(normal, farthest) + plane.w < 0.0f) return FrustumOverlap::Outside;
+        // Coltul cel mai apropiat: daca e in afara, planul taie cutia
+        glm::vec3 nearest(plane.x >= 0.0f ? box.min.x : box.max.x, plane.y >= 0.0f ? box.min.y : box.max.y, plane.z >= 0.0f ? box.min.z : box.max.z);
+        if (glm::dot(normal, nearest) + plane.w < 0.0f) result = FrustumOverlap::Intersecting;
+    }
+    return result;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "bounds.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Culling pe frustum pentru multe obiecte deodata: volumele sunt tinute SoA (cate un vector per componenta)
+// si testate cate 4 (SSE) sau 8 (AVX, cand proiectul e compilat cu /arch:AVX) pe iteratie.
+// Functioneaza cu orice matrice view-projection, deci si pentru trecerile de umbra.
+
+struct Frustum {
+    glm::vec4 planes[6]; // normalele spre interior, normalizate: dot(n, p) + w >= 0 inseamna in interior
+};
+
+// Gribb & Hartmann
+Frustum extractFrustum(const glm::mat4& viewProjection);
+
+// Sferele si AABB-urile obiectelor, in spatiul lumii
+struct CullingVolumes {
+    std::vector<float> centerX, centerY, centerZ, radius;
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+
+    size_t size() const { return radius.size(); }
+    void clear();
+    // Intoarce indexul volumului (pozitia lui in lista de vizibile)
+    uint32_t add(const Bounds& worldBounds);
+};
+
+// Un volum e vizibil daca nici sfera, nici AABB-ul nu sunt complet in afara vreunui plan.
+// visible e golit si primeste indicii volumelor vizibile, in ordine crescatoare.
+void cullVolumes(const Frustum& frustum, const CullingVolumes& volumes, std::vector<uint32_t>& visible);
+
+// Acelasi test pentru un singur volum
+bool isVisible(const Frustum& frustum, const Bounds& worldBounds);
+
+enum class FrustumOverlap { Outside, Intersecting, Inside };
+
+// Pentru parcurgeri ierarhice: o cutie Inside are tot continutul vizibil, fara alte teste
+FrustumOverlap classifyAabb(const Frustum& frustum, const Aabb& box);
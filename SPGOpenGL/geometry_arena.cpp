@@ -0,0 +1,118 @@
+#include "geometry_arena.h"
+#include <iostream>
+#include <algorithm>
+
+namespace {
+    const size_t DEFAULT_VERTEX_CAPACITY = 64 * 1024;
+    const size_t DEFAULT_INDEX_CAPACITY_BYTES = 1024 * 1024;
+
+    struct GeometryArena {
+        GLuint vao = 0, vbo = 0, ebo = 0;
+        VertexLayout layout = VertexLayout::Float;
+        size_t vertexCapacity = 0, vertexCount = 0;
+        size_t indexCapacity = 0, indexBytes = 0; // in octeti
+    };
+    GeometryArena arena;
+
+    // Muta continutul in buffere mai mari si reface legaturile din VAO
+    void growArena(size_t vertexCapacity, size_t indexCapacity) {
+        size_t stride = vertexStride(arena.layout);
+        GLuint vbo, ebo;
+        glGenBuffers(1, &vbo);
+        glGenBuffers(1, &ebo);
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity * stride, nullptr, GL_STATIC_DRAW);
+        if (arena.vertexCount) {
+            glBindBuffer(GL_COPY_READ_BUFFER, arena.vbo);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, arena.vertexCount * stride);
+        }
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+        glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity, nullptr, GL_STATIC_DRAW);
+        if (arena.indexBytes) {
+            glBindBuffer(GL_COPY_READ_BUFFER, arena.ebo);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, arena.indexBytes);
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        if (arena.vbo) glDeleteBuffers(1, &arena.vbo);
+        if (arena.ebo) glDeleteBuffers(1, &arena.ebo);
+        arena.vbo = vbo;
+        arena.ebo = ebo;
+        arena.vertexCapacity = vertexCapacity;
+        arena.indexCapacity = indexCapacity;
+
+        glBindVertexArray(arena.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, arena.vbo);
+        setupVertexAttributes(arena.layout);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.ebo);
+        glBindVertexArray(0);
+    }
+}
+
+void initGeometryArena(VertexLayout layout, size_t vertexCapacity, size_t indexCapacityBytes) {
+    if (arena.vao) {
+        std::cerr << "Geometry arena already initialized" << std::endl;
+        return;
+    }
+    arena.layout = layout;
+    glGenVertexArrays(1, &arena.vao);
+    growArena(std::max<size_t>(vertexCapacity, 1), std::max<size_t>(indexCapacityBytes, 4));
+}
+
+bool allocateGeometry(VertexLayout layout, size_t vertexCount, size_t indexBytes, GeometryRange& range) {
+    if (!arena.vao) initGeometryArena(layout, DEFAULT_VERTEX_CAPACITY, DEFAULT_INDEX_CAPACITY_BYTES);
+    if (layout != arena.layout) {
+        std::cerr << "Geometry arena: vertex layout differs from the arena layout" << std::endl;
+        return false;
+    }
+
+    size_t firstIndexByte = (arena.indexBytes + 3) & ~size_t(3);
+    size_t vertexCapacity = arena.vertexCapacity, indexCapacity = arena.indexCapacity;
+    while (arena.vertexCount + vertexCount > vertexCapacity) vertexCapacity *= 2;
+    while (firstIndexByte + indexBytes > indexCapacity) indexCapacity *= 2;
+    if (vertexCapacity != arena.vertexCapacity || indexCapacity != arena.indexCapacity) {
+        growArena(vertexCapacity, indexCapacity);
+        std::cout << "Geometry arena grown to " << geometryArenaCapacityBytes() / (1024.0 * 1024.0) << " MB" << std::endl;
+    }
+
+    range.baseVertex = (GLint)arena.vertexCount;
+    range.vertexCount = vertexCount;
+    range.firstIndexByte = firstIndexByte;
+    range.indexBytes = indexBytes;
+    arena.vertexCount += vertexCount;
+    arena.indexBytes = firstIndexByte + indexBytes;
+    return true;
+}
+
+void writeGeometryVertices(size_t byteOffset, const void* data, size_t size) {
+    if (!size) return;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, arena.vbo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)byteOffset, (GLsizeiptr)size, data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void writeGeometryIndices(size_t byteOffset, const void* data, size_t size) {
+    if (!size) return;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, arena.ebo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)byteOffset, (GLsizeiptr)size, data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+GLuint geometryArenaVao() {
+    return arena.vao;
+}
+
+void bindGeometryArena() {
+    glBindVertexArray(arena.vao);
+}
+
+size_t geometryArenaUsedBytes() {
+    return arena.vertexCount * vertexStride(arena.layout) + arena.indexBytes;
+}
+
+size_t geometryArenaCapacityBytes() {
+    return arena.vertexCapacity * vertexStride(arena.layout) + arena.indexCapacity;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "vertex_format.h"
+#include <GL/glew.h>
+#include <cstddef>
+
+// Arena pentru toata geometria statica: un singur VBO + EBO, un singur VAO si un singur VertexLayout.
+// Fiecare mesh primeste un interval de vertecsi (baseVertex) si unul de indici (firstIndexByte);
+// indicii raman locali mesh-ului (16 sau 32 de biti), deci se deseneaza cu glDrawElementsBaseVertex.
+// Toate functiile se apeleaza doar pe thread-ul GL.
+
+struct GeometryRange {
+    GLint baseVertex = 0;
+    size_t vertexCount = 0;
+    size_t firstIndexByte = 0; // aliniat la 4 octeti, valid pentru ambele tipuri de indici
+    size_t indexBytes = 0;
+};
+
+// Capacitatile initiale; bufferele se dubleaza (cu copiere pe GPU) cand nu mai ajung
+void initGeometryArena(VertexLayout layout, size_t vertexCapacity, size_t indexCapacityBytes);
+
+// Rezerva un interval; arena se initializeaza la prima folosire daca initGeometryArena nu a fost apelat.
+// Intoarce false daca layout difera de cel al arenei.
+bool allocateGeometry(VertexLayout layout, size_t vertexCount, size_t indexBytes, GeometryRange& range);
+
+// Scrie in VBO / EBO la offset-uri absolute in octeti (de ex. baseVertex * vertexStride)
+void writeGeometryVertices(size_t byteOffset, const void* data, size_t size);
+void writeGeometryIndices(size_t byteOffset, const void* data, size_t size);
+
+// VAO-ul arenei; se leaga o data pe cadru inainte de toate desenele
+GLuint geometryArenaVao();
+void bindGeometryArena();
+
+// Octetii folositi / alocati, pentru statistici
+size_t geometryArenaUsedBytes();
+size_t geometryArenaCapacityBytes();
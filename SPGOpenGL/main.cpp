@@ -11,7 +11,20 @@
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <algorithm>
 #include "obj_loader.hpp"
+#include "mesh_lod.h"
+#include "meshlet.h"
+#include "mesh_streaming.h"
+#include "geometry_arena.h"
+#include "draw_batch.h"
+#include "mesh_instancing.h"
+#include "frustum_culling.h"
+#include "scene_bvh.h"
+#include "occlusion_culling.h"
+#include "portal_visibility.h"
+#include "texture_cache.h"
 #include "window_data.h" 
 
 #ifndef M_PI
@@ -25,6 +38,9 @@ const float ROOM_LENGTH = 20.0f;
 const float ROOM_HEIGHT = 5.0f;
 
 const float CAMERA_Y = -0.5f;
+// Corpul camerei pentru coliziuni: o coloana de la podea pana la ochi
+const float CAMERA_COLLISION_RADIUS = 0.3f;
+const float FLOOR_Y = -1.0f;
 const float CLAMP_EPS = 0.3f;
 const float ROOM_MIN_X = -ROOM_WIDTH / 2 + CLAMP_EPS;
 const float ROOM_MAX_X = ROOM_WIDTH / 2 - CLAMP_EPS;
@@ -41,9 +57,16 @@ glm::vec3 cameraUp = { 0.0f, 1.0f,  0.0f };
 float yaw = -90.0f, pitch = 0.0f, fov = 45.0f;
 
 GLuint shaderProgram;
-GLuint wallDiffuse, wallNormal;
-GLuint floorDiffuse, floorNormal;
-GLuint ceilDiffuse, ceilNormal;
+// Aceleasi shadere compilate cu BATCHED, pentru calea cu glMultiDrawElementsIndirect (0 daca nu e suportata)
+GLuint batchProgram = 0;
+bool useDrawBatch = false;
+// Oprit implicit: singurii ocluderi sunt peretii camerei, care o inconjoara, deci acum nu scot nimic (tasta O)
+bool useOcclusionCulling = false;
+// Varianta INSTANCED, pentru copiile desenate cu glDrawElementsInstanced (0 daca nu e suportata)
+GLuint instanceProgram = 0;
+// Varianta LAYERED, pentru camera: texturile fetelor sunt straturi in doua array-uri
+GLuint roomProgram = 0;
+GLuint roomAlbedoArray, roomNormalArray;
 
 bool keys[256] = { false };
 
@@ -65,6 +88,41 @@ bool autoLightingEnabled = true;
 float sunIntensityManual = 1.0f;
 bool sunEnabled = true;
 
+// Formatul vertecsilor pentru modele si camera (Compact = 20 octeti/vertex, vezi vertex_format.h)
+VertexLayout vertexLayout = VertexLayout::Compact;
+
+// LOD pentru camera. Nu exista inca treceri de umbra; cand vor exista, pot da un bias mai mare lui selectMeshLod.
+float cameraLodBias = 0.0f;
+// Refolosita de la un desen la altul ca sa nu se realoce in fiecare cadru
+MeshletDrawList meshletDrawList;
+
+// Timp maxim pe cadru pentru urcarea modelelor incarcate in fundal
+const double MESH_UPLOAD_BUDGET_MS = 2.0;
+
+// Capacitatea initiala a arenei de geometrie (camera, ferestre, modele); creste singura daca nu ajunge
+const size_t GEOMETRY_ARENA_VERTICES = 256 * 1024;
+const size_t GEOMETRY_ARENA_INDEX_BYTES = 4 * 1024 * 1024;
+
+// Obiect din scena desenat prin drawSceneObjects
+struct SceneObject {
+    const Mesh* mesh;
+    glm::mat4 model;
+    int lod;
+    bool polygonOffset;
+    bool lit; // atins de luminile candelabrului (queryChandelierInfluence)
+};
+
+// Un submesh al unui obiect; coada se sorteaza dupa texturile materialului
+struct DrawItem {
+    const SceneObject* object;
+    GLuint submesh;
+    GLuint diffuseTexture, normalTexture;
+};
+std::vector<SceneObject> sceneObjects;
+std::vector<DrawItem> drawQueue;
+// Un culler pentru fiecare obiect din sceneObjects (frustumul si inversele se calculeaza o data per obiect)
+std::vector<MeshletCuller> sceneCullers;
+
 //Candelabru
 Mesh chandelier;
 GLuint chandelierTex;
@@ -83,6 +141,48 @@ GLuint tableTex;
 glm::vec3 tablePos = { 1.0f, -0.95f, -5.0f };
 glm::vec3 tableScale = { 0.3f, 0.3f, 0.3f };
 float tableRotation = 0.0f;
+// Transformarile tuturor copiilor mesei, desenate cu un singur apel instantiat per submesh.
+// Aici e o singura masa, controlata din taste; o camera mobilata ar pune aici sute de copii.
+std::vector<glm::mat4> tableTransforms;
+MeshInstances tableInstances;
+
+// Matricele model ale obiectelor, folosite si la desenare si la coliziuni / bounds in spatiul lumii
+glm::mat4 chandelierModelMatrix() {
+    return glm::translate(glm::mat4(1.0f), chandelierPos);
+}
+
+glm::mat4 tableModelMatrix() {
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), tablePos);
+    model = glm::rotate(model, glm::radians(tableRotation), glm::vec3(0.0f, 1.0f, 0.0f));
+    return glm::scale(model, tableScale);
+}
+
+// Obiectele scenei in BVH (scene_bvh.h), pentru culling, coliziuni, alegerea cu mouse-ul si raza luminilor candelabrului.
+// userData e indexul copiei mesei in tableTransforms sau CHANDELIER_OBJECT.
+const uint32_t CHANDELIER_OBJECT = ~0u;
+SceneBvh sceneBvh;
+std::vector<BvhHandle> tableHandles; // cate unul pentru fiecare copie din tableTransforms
+std::vector<BvhHandle> bvhResults;
+// Obiectele atinse in cadrul curent de luminile candelabrului, sortate pentru binary_search
+std::vector<BvhHandle> chandelierLitObjects;
+// Cat de departe ajunge raza aruncata la clic
+const float PICK_DISTANCE = 20.0f;
+
+// Recalculeaza copiile mesei si le muta in BVH (refit). Apelat cand masa e mutata din taste si cand termina de incarcat.
+void updateTableTransforms() {
+    tableTransforms.assign(1, tableModelMatrix());
+    if (table.lods.empty()) return; // limitele vin odata cu mesh-ul
+
+    while (tableHandles.size() > tableTransforms.size()) {
+        sceneBvh.remove(tableHandles.back());
+        tableHandles.pop_back();
+    }
+    for (size_t i = 0; i < tableTransforms.size(); i++) {
+        Aabb box = transformAabb(table.bounds.box, tableTransforms[i]);
+        if (i < tableHandles.size()) sceneBvh.update(tableHandles[i], box);
+        else tableHandles.push_back(sceneBvh.insert(box, (uint32_t)i));
+    }
+}
 
 
 glm::vec3 getSunColor(float timeOfDay) {
@@ -124,8 +224,10 @@ string readFile(const char* path) {
     return s;
 }
 
-GLuint compileShader(const char* path, GLenum type) {
+// header inlocuieste prima linie (#version) a fisierului, de ex. pentru variantele cu #define
+GLuint compileShader(const char* path, GLenum type, const char* header = nullptr) {
     string src = readFile(path);
+    if (header) src = header + src.substr(src.find('\n') + 1);
     const char* c = src.c_str();
     GLuint sh = glCreateShader(type);
     glShaderSource(sh, 1, &c, nullptr);
@@ -142,24 +244,39 @@ GLuint compileShader(const char* path, GLenum type) {
     return sh;
 }
 
-void initShaders() {
-    GLuint vs = compileShader("vertex.vert", GL_VERTEX_SHADER);
-    GLuint fs = compileShader("fragment.frag", GL_FRAGMENT_SHADER);
-    shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vs);
-    glAttachShader(shaderProgram, fs);
-    glLinkProgram(shaderProgram);
+GLuint linkProgram(const char* vertexPath, const char* fragmentPath, const char* header = nullptr) {
+    GLuint vs = compileShader(vertexPath, GL_VERTEX_SHADER, header);
+    GLuint fs = compileShader(fragmentPath, GL_FRAGMENT_SHADER, header);
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
 
     GLint success;
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success) {
         char infoLog[512];
-        glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
         cerr << "Shader linking failed: " << infoLog << endl;
+        glDeleteProgram(program);
+        program = 0;
     }
 
     glDeleteShader(vs);
     glDeleteShader(fs);
+    return program;
+}
+
+void initShaders() {
+    shaderProgram = linkProgram("vertex.vert", "fragment.frag");
+    if (drawBatchSupported()) {
+        batchProgram = linkProgram("vertex.vert", "fragment.frag",
+            "#version 430 core\n#extension GL_ARB_shader_draw_parameters : require\n#define BATCHED\n");
+    }
+    if (meshInstancingSupported()) {
+        instanceProgram = linkProgram("vertex.vert", "fragment.frag", "#version 430 core\n#define INSTANCED\n");
+    }
+    roomProgram = linkProgram("vertex.vert", "fragment.frag", "#version 330 core\n#define LAYERED\n");
 }
 
 glm::vec3 calculateSunPosition(float timeOfDay) {
@@ -225,40 +342,108 @@ void updateAutomaticLighting(float timeOfDay) {
     }
 }
 
-GLuint loadTex(const char* path) {
-    GLuint id; glGenTextures(1, &id);
+const TextureSampler NORMAL_MAP_SAMPLER = { GL_REPEAT, true, true };
+
+// Texturile incarcate la pornire. Acelasi tabel da si lista decodata in fundal (prefetchStartupTextures)
+// si apelurile acquireTexture / acquireTextureArray (acquireStartupTextures), deci o textura noua se adauga doar aici.
+struct StartupTexture {
+    GLuint* texture;
+    std::vector<std::string> paths; // un singur fisier, sau straturile unui array
+    TextureSampler sampler;
+    bool array;
+};
+
+const StartupTexture startupTextures[] = {
+    // In ordinea ROOM_FLOOR_LAYER, ROOM_CEILING_LAYER, ROOM_WALL_LAYER
+    { &roomAlbedoArray, { "Textures/FloorWood/floor_Color.jpg", "Textures/Ceiling/ceiling_Color.jpg",
+        "Textures/Wall/wall_Color.jpg" }, TextureSampler(), true },
+    { &roomNormalArray, { "Textures/FloorWood/floor_NormalGL.jpg", "Textures/Ceiling/ceiling_NormalGL.jpg",
+        "Textures/Wall/wall_NormalGL.jpg" }, NORMAL_MAP_SAMPLER, true },
+    { &chandelierTex, { "Objects/Chandelier/chandelier_diffuse.jpg" }, TextureSampler(), false },
+    { &tableTex, { "Objects/Table/table_diffuse.jpg" }, TextureSampler(), false },
+};
+
+void prefetchStartupTextures() {
+    for (const StartupTexture& entry : startupTextures) {
+        if (entry.array) prefetchTextureArray(entry.paths, entry.sampler);
+        else prefetchTexture(entry.paths[0], entry.sampler);
+    }
+}
+
+void acquireStartupTextures() {
+    for (const StartupTexture& entry : startupTextures) {
+        *entry.texture = entry.array ? acquireTextureArray(entry.paths, entry.sampler) : acquireTexture(entry.paths[0], entry.sampler);
+    }
+}
+
+void printTextureMemory() {
+    cout << "Resident textures: " << residentTextureCount() << " ("
+        << residentTextureBytes() / (1024.0 * 1024.0) << " MB)" << endl;
+}
+
+// Texturile materialelor vin din cache, deci un fisier folosit de mai multe materiale sau modele e urcat o singura data
+GLuint loadMaterialTexture(const string& path, GLuint fallback, const TextureSampler& sampler = TextureSampler()) {
+    GLuint id = 0;
     int w, h, comp;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(path, &w, &h, &comp, 0);
-    GLenum fmt = comp == 4 ? GL_RGBA : GL_RGB;
-    glBindTexture(GL_TEXTURE_2D, id);
-    glTexImage2D(GL_TEXTURE_2D, 0, fmt, w, h, 0, fmt, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    stbi_image_free(data);
-    if (!data) {
-        cerr << "Failed to load texture: " << path << endl;
+    if (!path.empty()) {
+        if (stbi_info(path.c_str(), &w, &h, &comp)) id = acquireTexture(path, sampler);
+        else cerr << "Material texture unavailable, using fallback: " << path << endl;
+    }
+    // Si rezerva primeste o referinta, ca fiecare textura de material sa poata fi eliberata la fel
+    if (!id) {
+        id = fallback;
+        retainTexture(id);
     }
     return id;
 }
 
-//collision detection
-bool checkBoxCollision(const glm::vec3& pos, const glm::vec3& boxCenter, const glm::vec3& boxSize) {
-    float margin = 0.3f;
-    return (pos.x >= boxCenter.x - boxSize.x - margin && pos.x <= boxCenter.x + boxSize.x + margin &&
-        pos.z >= boxCenter.z - boxSize.z - margin && pos.z <= boxCenter.z + boxSize.z + margin);
+void addMeshToDrawBatch(const Mesh& mesh) {
+    for (const Material& material : mesh.materials) {
+        addBatchTexture(material.diffuseTexture);
+        addBatchTexture(material.normalTexture);
+    }
 }
 
-bool checkTableCollision(const glm::vec3& pos) {
-    glm::vec3 tableSize = glm::vec3(1.5f, 0.5f, 0.8f) * tableScale.x;
-    return checkBoxCollision(pos, tablePos, tableSize);
+// Copiile din array-urile batch-ului exista doar cat timp batch-ul e pornit; oprit, fiecare textura e in memorie o data.
+// Modelele inca neincarcate nu au materiale; le adauga loadMaterialTextures cand ajung.
+void setDrawBatch(bool enabled) {
+    useDrawBatch = enabled;
+    if (!enabled) {
+        releaseDrawBatchTextures();
+        return;
+    }
+    addBatchTextureArray(roomAlbedoArray);
+    addBatchTextureArray(roomNormalArray);
+    addMeshToDrawBatch(chandelier);
+    addMeshToDrawBatch(table);
+}
+
+// map_Kd / map_Bump din .mtl; fara harta difuza se foloseste fallback,
+// fara normal map se foloseste tot textura difuza (ca inainte de materiale)
+void loadMaterialTextures(Mesh& mesh, GLuint fallback) {
+    for (Material& material : mesh.materials) {
+        material.diffuseTexture = loadMaterialTexture(material.diffuseMap, fallback);
+        material.normalTexture = material.normalMap.empty()
+            ? material.diffuseTexture
+            : loadMaterialTexture(material.normalMap, material.diffuseTexture, NORMAL_MAP_SAMPLER);
+        if (material.normalMap.empty()) retainTexture(material.diffuseTexture);
+    }
+    // Copiate in array-urile batch-ului acum, nu la primul cadru in care apar
+    if (useDrawBatch) addMeshToDrawBatch(mesh);
+    printTextureMemory();
 }
 
+//collision detection
 bool checkAllCollisions(const glm::vec3& newPos) {
-    return checkTableCollision(newPos);
+    Aabb body;
+    body.min = glm::vec3(newPos.x - CAMERA_COLLISION_RADIUS, FLOOR_Y, newPos.z - CAMERA_COLLISION_RADIUS);
+    body.max = glm::vec3(newPos.x + CAMERA_COLLISION_RADIUS, newPos.y, newPos.z + CAMERA_COLLISION_RADIUS);
+    sceneBvh.queryAabb(body, bvhResults);
+    for (BvhHandle handle : bvhResults) {
+        // Candelabrul e deasupra capului; doar mesele opresc camera
+        if (sceneBvh.userData(handle) != CHANDELIER_OBJECT) return true;
+    }
+    return false;
 }
 
 void doMovement() {
@@ -444,8 +629,19 @@ void keyDown(unsigned char k, int x, int y) {
         tablePos.z -= 0.1f;
         cout << "Table Z: " << tablePos.z << endl;
     }
+    if ((k >= '5' && k <= '9') || k == '0') updateTableTransforms();
 
     // Help
+    if (k == 'i' || k == 'I') {
+        if (batchProgram) {
+            setDrawBatch(!useDrawBatch);
+            cout << "Multi-draw indirect: " << (useDrawBatch ? "ON" : "OFF") << endl;
+        }
+    }
+    if (k == 'o' || k == 'O') {
+        useOcclusionCulling = !useOcclusionCulling;
+        cout << "Occlusion culling: " << (useOcclusionCulling ? "ON" : "OFF") << endl;
+    }
     if (k == 'h' || k == 'H') {
         cout << "\n=== ENHANCED LIGHT CONTROLS ===" << endl;
         cout << "C - Toggle Chandelier ON/OFF (disables auto)" << endl;
@@ -463,6 +659,9 @@ void keyDown(unsigned char k, int x, int y) {
         cout << "Sunrise: 6:00, Sunset: 21:00" << endl;
         cout << "Auto lighting: " << (autoLightingEnabled ? "ON" : "OFF") << endl;
         cout << "Table controls: 5/6 rotate, 7/8 move X, 9/0 move Z" << endl;
+        cout << "I - Toggle multi-draw indirect rendering" << endl;
+        cout << "O - Toggle occlusion culling" << endl;
+        cout << "Left click - Pick the object in the center of the screen" << endl;
         cout << "H - Show this help" << endl;
         cout << "===============================" << endl;
     }
@@ -484,6 +683,20 @@ void mouseMove(int x, int y) {
     glutWarpPointer(cx, cy);
 }
 
+// Clic stanga: obiectul din centrul ecranului (cursorul e ascuns si tinut in centru), cu o raza prin BVH
+void mouseClick(int button, int state, int x, int y) {
+    if (button != GLUT_LEFT_BUTTON || state != GLUT_DOWN) return;
+    BvhRayHit hit;
+    if (!sceneBvh.raycast(cameraPos, cameraFront, PICK_DISTANCE, hit)) {
+        cout << "Picked: nothing" << endl;
+        return;
+    }
+    uint32_t object = sceneBvh.userData(hit.handle);
+    if (object == CHANDELIER_OBJECT) cout << "Picked: chandelier";
+    else cout << "Picked: table " << object;
+    cout << " at " << hit.distance << endl;
+}
+
 void reshape(int w, int h) { glViewport(0, 0, w, h); }
 void idle() { glutPostRedisplay(); }
 
@@ -502,6 +715,26 @@ void initLights() {
     }
 }
 
+// Distanta la care un bec (atenuarea din fragment.frag, la intensitatea curenta) aduce sub 1/256
+float chandelierLightRange() {
+    float c = 1.0f - 256.0f * lightIntensity;
+    if (c >= 0.0f) return 0.0f;
+    return (-0.14f + sqrt(0.14f * 0.14f - 4.0f * 0.07f * c)) / (2.0f * 0.07f);
+}
+
+// O sfera de influenta pentru fiecare bec; obiectele din afara lor sunt desenate fara luminile candelabrului
+void queryChandelierInfluence() {
+    chandelierLitObjects.clear();
+    float range = chandelierLightRange();
+    if (!chandelierEnabled || range <= 0.0f) return;
+    for (int i = 0; i < numLights; i++) {
+        sceneBvh.querySphere(lightPositions[i], range, bvhResults);
+        chandelierLitObjects.insert(chandelierLitObjects.end(), bvhResults.begin(), bvhResults.end());
+    }
+    std::sort(chandelierLitObjects.begin(), chandelierLitObjects.end());
+    chandelierLitObjects.erase(std::unique(chandelierLitObjects.begin(), chandelierLitObjects.end()), chandelierLitObjects.end());
+}
+
 void setLightingUniforms(GLuint program, const glm::vec3& viewPos) {
     glUniform3fv(glGetUniformLocation(program, "viewPos"), 1, glm::value_ptr(viewPos));
 
@@ -523,37 +756,249 @@ void setLightingUniforms(GLuint program, const glm::vec3& viewPos) {
     glUniform1f(glGetUniformLocation(program, "timeOfDay"), timeOfDay);
 }
 
-void drawTable(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& viewPos) {
+DrawItem makeDrawItem(const SceneObject& object, GLuint submesh) {
+    const Mesh& mesh = *object.mesh;
+    GLuint material = mesh.submeshes[submesh].material;
+    DrawItem item = { &object, submesh, 0, 0 };
+    if (material < mesh.materials.size()) {
+        item.diffuseTexture = mesh.materials[material].diffuseTexture;
+        item.normalTexture = mesh.materials[material].normalTexture;
+    }
+    return item;
+}
+
+// Deseneaza drawQueue sortat dupa material, ca texturile sa fie schimbate doar la granita dintre materiale
+void drawQueuedObjects(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& viewPos) {
     glUseProgram(shaderProgram);
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LEQUAL);
+    setLightingUniforms(shaderProgram, viewPos);
+    glUniform1i(glGetUniformLocation(shaderProgram, "texture1"), 0);
+    glUniform1i(glGetUniformLocation(shaderProgram, "texture2"), 1);
+    GLint numLightsLocation = glGetUniformLocation(shaderProgram, "numLights");
+    glPolygonOffset(-1.0f, -1.0f);
 
-    glm::mat4 tableModel = glm::translate(glm::mat4(1.0f), tablePos);
-    tableModel = glm::rotate(tableModel, glm::radians(tableRotation), glm::vec3(0.0f, 1.0f, 0.0f));
-    tableModel = glm::scale(tableModel, tableScale);
+    std::sort(drawQueue.begin(), drawQueue.end(), [](const DrawItem& a, const DrawItem& b) {
+        if (a.diffuseTexture != b.diffuseTexture) return a.diffuseTexture < b.diffuseTexture;
+        if (a.normalTexture != b.normalTexture) return a.normalTexture < b.normalTexture;
+        return a.object < b.object;
+    });
+
+    sceneCullers.clear();
+    for (const SceneObject& object : sceneObjects) sceneCullers.emplace_back(object.model, view, projection);
+
+    const SceneObject* currentObject = nullptr;
+    GLuint currentDiffuse = ~0u, currentNormal = ~0u;
+    for (const DrawItem& item : drawQueue) {
+        if (item.diffuseTexture != currentDiffuse) {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, item.diffuseTexture);
+            currentDiffuse = item.diffuseTexture;
+        }
+        if (item.normalTexture != currentNormal) {
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, item.normalTexture);
+            currentNormal = item.normalTexture;
+        }
 
-    glm::mat4 tableMVP = projection * view * tableModel;
-    glm::mat4 tableNormalMatrix = glm::transpose(glm::inverse(tableModel));
+        const SceneObject& object = *item.object;
+        if (&object != currentObject) {
+            glm::mat4 vertexModel = object.model * object.mesh->positionTransform;
+            glm::mat4 mvp = projection * view * vertexModel;
+            glm::mat4 normalMatrix = glm::transpose(glm::inverse(object.model));
+            glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "mvpMatrix"), 1, GL_FALSE, glm::value_ptr(mvp));
+            glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "modelMatrix"), 1, GL_FALSE, glm::value_ptr(vertexModel));
+            glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "normalMatrix"), 1, GL_FALSE, glm::value_ptr(normalMatrix));
+            glUniform1i(numLightsLocation, object.lit ? numLights : 0);
+            if (object.polygonOffset) glEnable(GL_POLYGON_OFFSET_FILL);
+            else glDisable(GL_POLYGON_OFFSET_FILL);
+            currentObject = &object;
+        }
 
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "mvpMatrix"), 1, GL_FALSE, glm::value_ptr(tableMVP));
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "modelMatrix"), 1, GL_FALSE, glm::value_ptr(tableModel));
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "normalMatrix"), 1, GL_FALSE, glm::value_ptr(tableNormalMatrix));
+        meshletDrawList.clear();
+        cullSubMesh(sceneCullers[&object - sceneObjects.data()], *object.mesh, item.submesh, meshletDrawList);
+        drawMeshlets(*object.mesh, meshletDrawList);
+    }
+    glDisable(GL_POLYGON_OFFSET_FILL);
+}
 
-    setLightingUniforms(shaderProgram, viewPos);
+// Toate submesh-urile obiectelor din scena, cate un desen per material
+void drawSceneObjects(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& viewPos) {
+    drawQueue.clear();
+    for (const SceneObject& object : sceneObjects) {
+        const Mesh& mesh = *object.mesh;
+        if (mesh.lods.empty()) continue;
+        const MeshLod& level = mesh.lods[std::min(std::max(object.lod, 0), (int)mesh.lods.size() - 1)];
+        for (GLuint s = level.firstSubmesh; s < level.firstSubmesh + level.submeshCount; s++) {
+            drawQueue.push_back(makeDrawItem(object, s));
+        }
+    }
+    drawQueuedObjects(projection, view, viewPos);
+}
 
-    glEnable(GL_POLYGON_OFFSET_FILL);
+// Camera cu programul ei (array-uri de texturi, vezi room_data.h)
+void drawRoomPass(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& viewPos, unsigned roomFaces) {
+    glUseProgram(roomProgram);
+    // Soarele si ora nu sunt setate de drawRoom
+    setLightingUniforms(roomProgram, viewPos);
+    drawRoom(projection, view, lightPositions, chandelierEnabled ? numLights : 0, viewPos, 1.0f, lightIntensity, sunPosition,
+        calculateNaturalLightIntensity(timeOfDay), timeOfDay, roomFaces);
+}
+
+// Obiectele si camera cu cate un glMultiDrawElementsIndirect per grup de stare (vezi draw_batch.h):
+// fara schimbari de uniform-uri sau texturi intre desene. Submesh-urile cu texturi care nu sunt in batch
+// (si camera, daca array-urile ei lipsesc) se deseneaza apoi pe calea obisnuita, nu cu un layer oarecare.
+void drawSceneBatched(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& viewPos, unsigned roomFaces) {
+    glUseProgram(batchProgram);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    setLightingUniforms(batchProgram, viewPos);
+    glm::mat4 viewProjection = projection * view;
+    glUniformMatrix4fv(glGetUniformLocation(batchProgram, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
     glPolygonOffset(-1.0f, -1.0f);
 
-    glUniform1i(glGetUniformLocation(shaderProgram, "texture1"), 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tableTex);
-    glUniform1i(glGetUniformLocation(shaderProgram, "texture2"), 1);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, tableTex);
+    beginDrawBatch();
+    drawQueue.clear();
+    for (const SceneObject& object : sceneObjects) {
+        const Mesh& mesh = *object.mesh;
+        if (mesh.lods.empty()) continue;
+        const MeshLod& level = mesh.lods[std::min(std::max(object.lod, 0), (int)mesh.lods.size() - 1)];
+        // Fara luminile candelabrului, intensitatea lor e anulata
+        BatchDrawData data = { object.model * mesh.positionTransform, glm::transpose(glm::inverse(object.model)), -1, -1, 1.0f,
+            object.lit ? 0.0f : -lightIntensity };
+        MeshletCuller culler(object.model, view, projection);
+        for (GLuint s = level.firstSubmesh; s < level.firstSubmesh + level.submeshCount; s++) {
+            meshletDrawList.clear();
+            cullSubMesh(culler, mesh, s, meshletDrawList);
+            if (meshletDrawList.counts.empty()) continue;
+
+            DrawItem item = makeDrawItem(object, s);
+            BatchTextureSlot diffuse = batchTextureSlot(item.diffuseTexture);
+            BatchTextureSlot normal = batchTextureSlot(item.normalTexture);
+            if (diffuse.array < 0 || normal.array < 0) {
+                drawQueue.push_back(item);
+                continue;
+            }
+            addBatchRanges(mesh, meshletDrawList, addBatchDrawData(data, diffuse, normal), object.polygonOffset);
+        }
+    }
+    bool roomBatched = addRoomToDrawBatch(1.0f, roomFaces);
+    submitDrawBatch(batchProgram);
 
-    glBindVertexArray(table.vao);
-    glDrawElements(GL_TRIANGLES, table.indexCount, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    if (!drawQueue.empty()) drawQueuedObjects(projection, view, viewPos);
+    if (!roomBatched) drawRoomPass(projection, view, viewPos, roomFaces);
+}
+
+// Copiile mesei date (cele vizibile) cu drawMeshInstances, la LOD-ul celei mai apropiate copii.
+// Luminile candelabrului sunt comune tuturor copiilor: lit daca macar una e in raza lor.
+void drawInstancedProps(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& viewPos,
+    const std::vector<glm::mat4>& transforms, bool lit) {
+    if (table.lods.empty() || transforms.empty()) return;
+    // Masa se muta din taste si setul vizibil se schimba cu camera, deci copiile se urca in fiecare cadru
+    updateMeshInstances(tableInstances, table, transforms);
+    int lod = (int)table.lods.size() - 1;
+    for (const glm::mat4& transform : transforms) {
+        lod = std::min(lod, selectMeshLod(table, transform, view, projection, (float)HEIGHT, cameraLodBias));
+    }
+
+    glUseProgram(instanceProgram);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    setLightingUniforms(instanceProgram, viewPos);
+    if (!lit) glUniform1i(glGetUniformLocation(instanceProgram, "numLights"), 0);
+    glm::mat4 viewProjection = projection * view;
+    glUniformMatrix4fv(glGetUniformLocation(instanceProgram, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+    glUniform1i(glGetUniformLocation(instanceProgram, "texture1"), 0);
+    glUniform1i(glGetUniformLocation(instanceProgram, "texture2"), 1);
+
+    glPolygonOffset(-1.0f, -1.0f);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    drawMeshInstances(tableInstances, table, lod);
+    glDisable(GL_POLYGON_OFFSET_FILL);
+}
+
+// Ce a ramas dupa cullScene pentru o matrice view-projection
+struct SceneVisibility {
+    bool chandelier = false;
+    bool chandelierLit = false;
+    std::vector<glm::mat4> tableTransforms; // copiile vizibile din tableTransforms
+    std::vector<char> tableLit;             // pentru fiecare din tableTransforms, din chandelierLitObjects
+    unsigned roomFaces = 0;                 // bitul i = fata i a camerei (room_data.h)
+    unsigned windows = 0;                   // bitul w = fereastra w (window_data.h)
+};
+CullingVolumes cullingVolumes;
+std::vector<uint32_t> visibleVolumes;
+SceneVisibility cameraVisibility;
+// Peretii, podeaua si tavanul ca ocluderi pentru obiectele din BVH (tasta O)
+OcclusionBuffer occlusionBuffer;
+// Cladirea ca celule si portaluri: camera din room_data e o celula, iar ferestrele sunt portaluri spre exterior
+PortalGraph building;
+int roomCell = PORTAL_EXTERIOR;
+int windowPortals[WINDOW_COUNT];
+PortalVisibility portalVisibility;
+
+void initBuilding() {
+    Aabb bounds = roomFaceBounds(0).box;
+    for (int face = 1; face < ROOM_FACE_COUNT; face++) {
+        bounds.min = glm::min(bounds.min, roomFaceBounds(face).box.min);
+        bounds.max = glm::max(bounds.max, roomFaceBounds(face).box.max);
+    }
+    roomCell = building.addCell(bounds);
+    for (int window = 0; window < WINDOW_COUNT; window++) {
+        windowPortals[window] = building.addPortal(windowPolygon(window), roomCell, PORTAL_EXTERIOR);
+    }
+}
+
+// Culling pe frustum pentru toata scena: obiectele din BVH, iar fetele camerei si ferestrele (statice si putine)
+// intr-o singura trecere SIMD (frustum_culling.h).
+// Merge cu orice view-projection: camera sau, pentru o trecere de umbra, getSunLightSpaceMatrix().
+// Cu occlusion (randat cu aceeasi matrice), obiectele ascunse de pereti sunt scoase si ele.
+// Cu portals, tot ce e intr-o celula la care nu se ajunge prin portaluri e scos, la fel ca ferestrele nevazute.
+void cullScene(const glm::mat4& viewProjection, SceneVisibility& visibility, const OcclusionBuffer* occlusion = nullptr,
+    const PortalVisibility* portals = nullptr) {
+    Frustum frustum = extractFrustum(viewProjection);
+
+    visibility.chandelier = false;
+    visibility.tableTransforms.clear();
+    visibility.tableLit.clear();
+    sceneBvh.queryFrustum(frustum, bvhResults);
+    for (BvhHandle handle : bvhResults) {
+        if (portals) {
+            int cell = building.findCell(sceneBvh.bounds(handle).center());
+            if (cell != PORTAL_EXTERIOR && !portals->cells[cell]) continue;
+        }
+        if (occlusion && !occlusion->isVisible(sceneBvh.bounds(handle))) continue;
+        uint32_t object = sceneBvh.userData(handle);
+        bool lit = std::binary_search(chandelierLitObjects.begin(), chandelierLitObjects.end(), handle);
+        if (object == CHANDELIER_OBJECT) {
+            visibility.chandelier = true;
+            visibility.chandelierLit = lit;
+        }
+        else {
+            visibility.tableTransforms.push_back(tableTransforms[object]);
+            visibility.tableLit.push_back(lit);
+        }
+    }
+
+    cullingVolumes.clear();
+    for (int face = 0; face < ROOM_FACE_COUNT; face++) cullingVolumes.add(roomFaceBounds(face));
+    uint32_t firstWindow = (uint32_t)cullingVolumes.size();
+    for (int window = 0; window < WINDOW_COUNT; window++) cullingVolumes.add(windowBounds(window));
+
+    cullVolumes(frustum, cullingVolumes, visibleVolumes);
+
+    visibility.roomFaces = visibility.windows = 0;
+    for (uint32_t index : visibleVolumes) {
+        if (index < firstWindow) visibility.roomFaces |= 1u << index;
+        else visibility.windows |= 1u << (index - firstWindow);
+    }
+
+    if (portals) {
+        if (!portals->cells[roomCell]) visibility.roomFaces = 0;
+        for (int window = 0; window < WINDOW_COUNT; window++) {
+            if (!portals->portals[windowPortals[window]]) visibility.windows &= ~(1u << window);
+        }
+    }
 }
 
 void display() {
@@ -562,6 +1007,8 @@ void display() {
     lastFrame = now;
     doMovement();
 
+    uploadStreamedMeshes(MESH_UPLOAD_BUDGET_MS);
+
     if (autonomicMode) {
         timeOfDay += deltaTime * 24.0f / dayDuration;
         if (timeOfDay >= 24.0f) timeOfDay -= 24.0f;
@@ -574,41 +1021,50 @@ void display() {
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glUseProgram(shaderProgram);
+    // Toata geometria statica e in arena: un singur VAO pentru tot cadrul
+    bindGeometryArena();
 
     glm::mat4 proj = glm::perspective(glm::radians(fov), (float)WIDTH / HEIGHT, 0.1f, 100.0f);
     glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
     glm::vec3 viewPos = cameraPos;
 
-    glm::mat4 chandModel = glm::translate(glm::mat4(1.0f), chandelierPos);
-    chandModel = glm::scale(chandModel, glm::vec3(1.0f));
-
-    glm::mat4 chandMVP = proj * view * chandModel;
-    glm::mat4 chandNormalMatrix = glm::transpose(glm::inverse(chandModel));
-
-    glUseProgram(shaderProgram);
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "mvpMatrix"), 1, GL_FALSE, glm::value_ptr(chandMVP));
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "modelMatrix"), 1, GL_FALSE, glm::value_ptr(chandModel));
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "normalMatrix"), 1, GL_FALSE, glm::value_ptr(chandNormalMatrix));
-
-    setLightingUniforms(shaderProgram, viewPos);
+    glm::mat4 chandModel = chandelierModelMatrix();
+    if (useOcclusionCulling) occlusionBuffer.render(proj * view);
+    queryChandelierInfluence();
+    building.computeVisibility(viewPos, extractFrustum(proj * view), portalVisibility);
+    cullScene(proj * view, cameraVisibility, useOcclusionCulling ? &occlusionBuffer : nullptr, &portalVisibility);
 
-    glUniform1i(glGetUniformLocation(shaderProgram, "texture1"), 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, chandelierTex);
-    glUniform1i(glGetUniformLocation(shaderProgram, "texture2"), 1);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, chandelierTex);
-
-    glBindVertexArray(chandelier.vao);
-    glDrawElements(GL_TRIANGLES, chandelier.indexCount, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    sceneObjects.clear();
+    if (cameraVisibility.chandelier) {
+        sceneObjects.push_back({ &chandelier, chandModel, selectMeshLod(chandelier, chandModel, view, proj, (float)HEIGHT, cameraLodBias), false,
+            cameraVisibility.chandelierLit });
+    }
+    if (!instanceProgram) {
+        // Fara instancing, fiecare copie vizibila e un obiect separat
+        for (size_t i = 0; i < cameraVisibility.tableTransforms.size(); i++) {
+            const glm::mat4& transform = cameraVisibility.tableTransforms[i];
+            sceneObjects.push_back({ &table, transform, selectMeshLod(table, transform, view, proj, (float)HEIGHT, cameraLodBias), true,
+                cameraVisibility.tableLit[i] != 0 });
+        }
+    }
 
     float sunIntensity = calculateNaturalLightIntensity(timeOfDay);
     glm::vec3 currentSunColor = getSunColor(timeOfDay);
 
-    drawTable(proj, view, viewPos);
-    drawRoom(proj, view, lightPositions, chandelierEnabled ? numLights : 0, viewPos, 1.0f, lightIntensity, sunPosition, sunIntensity, timeOfDay);
-    drawWindows(proj, view, viewPos, timeOfDay, sunPosition, sunIntensity);
+    if (useDrawBatch) {
+        drawSceneBatched(proj, view, viewPos, cameraVisibility.roomFaces);
+    }
+    else {
+        drawSceneObjects(proj, view, viewPos);
+        drawRoomPass(proj, view, viewPos, cameraVisibility.roomFaces);
+    }
+    if (instanceProgram) {
+        bool tablesLit = std::find(cameraVisibility.tableLit.begin(), cameraVisibility.tableLit.end(), 1) != cameraVisibility.tableLit.end();
+        drawInstancedProps(proj, view, viewPos, cameraVisibility.tableTransforms, tablesLit);
+    }
+    // Ferestrele sunt transparente, deci raman in afara batch-ului
+    drawWindows(proj, view, viewPos, timeOfDay, sunPosition, sunIntensity, cameraVisibility.windows);
+    glBindVertexArray(0);
 
     glutSwapBuffers();
 }
@@ -628,31 +1084,44 @@ int main(int argc, char** argv) {
     glutKeyboardFunc(keyDown);
     glutKeyboardUpFunc(keyUp);
     glutPassiveMotionFunc(mouseMove);
+    glutMouseFunc(mouseClick);
     glutIdleFunc(idle);
 
+    // Imaginile de la pornire se decodeaza in paralel cu restul initializarii; acquireStartupTextures doar le urca
+    prefetchStartupTextures();
+    prefetchWindowTextures();
+
     initShaders();
+    cout << "Multi-draw indirect: " << (batchProgram ? "ON" : "unsupported") << endl;
     initWindowShaders();
     loadWindowTextures();
 
     initLights();
-    initWindows();
-
-    wallDiffuse = loadTex("Textures/Wall/wall_Color.jpg");
-    wallNormal = loadTex("Textures/Wall/wall_NormalGL.jpg");
+    initGeometryArena(vertexLayout, GEOMETRY_ARENA_VERTICES, GEOMETRY_ARENA_INDEX_BYTES);
+    initWindows(vertexLayout);
 
-    floorDiffuse = loadTex("Textures/FloorWood/floor_Color.jpg");
-    floorNormal = loadTex("Textures/FloorWood/floor_NormalGL.jpg");
+    acquireStartupTextures();
+    setDrawBatch(batchProgram != 0);
 
-    ceilDiffuse = loadTex("Textures/Ceiling/ceiling_Color.jpg");
-    ceilNormal = loadTex("Textures/Ceiling/ceiling_NormalGL.jpg");
+    ObjLoadOptions meshOptions;
+    meshOptions.layout = vertexLayout;
 
-    chandelier = loadOBJ("Objects/Chandelier/chandelier.obj");
-    chandelierTex = loadTex("Objects/Chandelier/chandelier_diffuse.jpg");
+    // Modelele se incarca in fundal si apar cand sunt gata; texturile materialelor se incarca pe thread-ul GL
+    streamMesh("Objects/Chandelier/chandelier.obj", meshOptions, &chandelier, [](Mesh& mesh) {
+        loadMaterialTextures(mesh, chandelierTex);
+        sceneBvh.insert(transformAabb(mesh.bounds.box, chandelierModelMatrix()), CHANDELIER_OBJECT);
+    });
 
-    table = loadOBJ("Objects/Table/table.obj");
-    tableTex = loadTex("Objects/Table/table_diffuse.jpg");
+    streamMesh("Objects/Table/table.obj", meshOptions, &table, [](Mesh& mesh) {
+        loadMaterialTextures(mesh, tableTex);
+        updateTableTransforms();
+    });
+    updateTableTransforms();
 
-    initRoom(wallDiffuse, wallNormal, floorDiffuse, floorNormal, ceilDiffuse, ceilNormal, shaderProgram);
+    initRoom(roomAlbedoArray, roomNormalArray, roomProgram, vertexLayout);
+    occlusionBuffer.setOccluders(roomOccluderTriangles());
+    initBuilding();
+    printTextureMemory();
 
     timeOfDay = 12.0f;
     sunPosition = calculateSunPosition(timeOfDay);
@@ -670,6 +1139,9 @@ int main(int argc, char** argv) {
     cout << "M - Change time by 15 minutes" << endl;
     cout << "T - Toggle autonomic time mode" << endl;
     cout << "Table controls: 5/6 rotate, 7/8 move X, 9/0 move Z" << endl;
+    cout << "I - Toggle multi-draw indirect rendering" << endl;
+    cout << "O - Toggle occlusion culling" << endl;
+    cout << "Left click - Pick the object in the center of the screen" << endl;
     cout << "Sunrise: 6:00, Sunset: 21:00" << endl;
     cout << "Auto lighting: " << (autoLightingEnabled ? "ON" : "OFF") << endl;
     cout << "H - Show help" << endl;
@@ -0,0 +1,128 @@
+#include "mapped_file.h"
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char emptyFile[1] = { 0 };
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    opened = true;
+    length = (size_t)fileSize.QuadPart;
+    if (length == 0) {
+        ptr = emptyFile;
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        close();
+        return false;
+    }
+    mappingHandle = mapping;
+
+    ptr = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!ptr) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (ptr && ptr != emptyFile) UnmapViewOfFile(ptr);
+    if (mappingHandle) CloseHandle((HANDLE)mappingHandle);
+    if (fileHandle) CloseHandle((HANDLE)fileHandle);
+    ptr = nullptr;
+    length = 0;
+    opened = false;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close();
+        return false;
+    }
+
+    opened = true;
+    length = (size_t)st.st_size;
+    if (length == 0) {
+        ptr = emptyFile;
+        return true;
+    }
+
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        close();
+        return false;
+    }
+    madvise(mapped, length, MADV_SEQUENTIAL);
+    ptr = (const char*)mapped;
+    return true;
+}
+
+void MappedFile::close() {
+    if (ptr && ptr != emptyFile) munmap((void*)ptr, length);
+    if (fd >= 0) ::close(fd);
+    ptr = nullptr;
+    length = 0;
+    opened = false;
+    fd = -1;
+}
+
+#endif
+
+uint64_t hashBytes(const void* data, size_t size) {
+    const uint64_t prime = 0x100000001B3ull;
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t h = 0xCBF29CE484222325ull ^ (size * 0x9E3779B97F4A7C15ull);
+
+    // 8 octeti odata, apoi restul ca FNV-1a
+    size_t words = size / 8;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t w;
+        memcpy(&w, p + i * 8, 8);
+        h ^= w * 0xFF51AFD7ED558CCDull;
+        h = (h << 31 | h >> 33) * 0xC4CEB9FE1A85EC53ull;
+    }
+    for (size_t i = words * 8; i < size; i++) {
+        h = (h ^ p[i]) * prime;
+    }
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    return h;
+}
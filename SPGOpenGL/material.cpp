@@ -0,0 +1,72 @@
+#include "material.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+namespace {
+    std::string directoryOf(const std::string& path) {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    }
+
+    // Ultimul cuvant de pe linie; optiunile dinaintea fisierului (de ex. "-bm 1.0") se ignora
+    std::string mapFile(std::stringstream& ss) {
+        std::string token, file;
+        while (ss >> token) file = token;
+        return file;
+    }
+}
+
+bool parseMTL(const std::string& path, std::vector<Material>& materials) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::string directory = directoryOf(path);
+    Material* current = nullptr;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string type;
+        ss >> type;
+
+        if (type == "newmtl") {
+            materials.push_back({});
+            current = &materials.back();
+            ss >> current->name;
+        }
+        else if (!current) {
+            continue;
+        }
+        else if (type == "map_Kd") {
+            std::string map = mapFile(ss);
+            if (!map.empty()) current->diffuseMap = directory + map;
+        }
+        else if (type == "map_Bump" || type == "map_bump" || type == "bump" || type == "norm") {
+            std::string map = mapFile(ss);
+            if (!map.empty()) current->normalMap = directory + map;
+        }
+    }
+    return true;
+}
+
+void resolveMaterials(const std::string& objPath, const std::string& library, std::vector<Material>& materials) {
+    if (library.empty()) return;
+
+    std::string path = directoryOf(objPath) + library;
+    std::vector<Material> parsed;
+    if (!parseMTL(path, parsed)) {
+        std::cerr << "Could not open material library: " << path << std::endl;
+        return;
+    }
+
+    for (Material& material : materials) {
+        for (const Material& candidate : parsed) {
+            if (candidate.name == material.name) {
+                material.diffuseMap = candidate.diffuseMap;
+                material.normalMap = candidate.normalMap;
+                break;
+            }
+        }
+    }
+}
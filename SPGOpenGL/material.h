@@ -0,0 +1,21 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+
+// Material dintr-un fisier .mtl. Se pastreaza doar ce foloseste fragment.frag:
+// texture1 = harta difuza (map_Kd), texture2 = normal map (map_Bump / bump / norm).
+struct Material {
+    std::string name;
+    std::string diffuseMap; // cai rezolvate fata de directorul fisierului .mtl
+    std::string normalMap;
+    GLuint diffuseTexture = 0; // completate de aplicatie dupa incarcarea texturilor
+    GLuint normalTexture = 0;
+};
+
+bool parseMTL(const std::string& path, std::vector<Material>& materials);
+
+// Completeaza materialele (care au deja numele din usemtl) din biblioteca mtllib a modelului objPath.
+// Materialele care lipsesc din .mtl raman fara texturi.
+void resolveMaterials(const std::string& objPath, const std::string& library, std::vector<Material>& materials);
@@ -0,0 +1,233 @@
+#include "mesh_cache.h"
+#include "mapped_file.h"
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+    const char MESH_CACHE_MAGIC[8] = { 'S', 'P', 'G', 'M', 'E', 'S', 'H', 0 };
+    const uint32_t MESH_CACHE_VERSION = 9;
+
+    struct MeshCacheHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+        uint64_t sourceHash;
+        uint32_t flags;
+        uint32_t vertexStride;   // octeti per vertex
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t submeshCount;
+        uint32_t indexSize;      // 2 sau 4 octeti per index
+        uint32_t lodCount;
+        uint32_t meshletCount;
+        uint32_t materialCount;
+        uint32_t materialNamesSize; // mtllib si numele materialelor, fiecare terminat cu '\0'
+        float boundsMin[3];
+        float boundsMax[3];
+        float boundingSphere[4]; // centru, raza
+        float dequantOffset[3];  // PositionDequantization pentru MESH_CACHE_COMPACT
+        float dequantScale[3];
+        uint64_t vertexOffset;   // offset-uri de la inceputul fisierului
+        uint64_t indexOffset;
+        uint64_t submeshOffset;
+        uint64_t lodOffset;
+        uint64_t meshletOffset;
+        uint64_t materialNamesOffset;
+        uint64_t fileSize;
+    };
+
+    VertexLayout layoutForFlags(uint32_t flags) {
+        return (flags & MESH_CACHE_COMPACT) ? VertexLayout::Compact : VertexLayout::Float;
+    }
+
+    uint64_t alignUp(uint64_t value) {
+        return (value + 15) & ~uint64_t(15);
+    }
+}
+
+std::string meshCachePath(const std::string& sourcePath) {
+    size_t dot = sourcePath.find_last_of('.');
+    size_t slash = sourcePath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return sourcePath + ".spgmesh";
+    }
+    return sourcePath.substr(0, dot) + ".spgmesh";
+}
+
+bool loadMeshCache(const std::string& cachePath, uint64_t sourceHash, uint32_t flags, MeshUpload& out) {
+    auto start = std::chrono::steady_clock::now();
+
+    MappedFile file(cachePath);
+    if (!file.isOpen() || file.size() < sizeof(MeshCacheHeader)) return false;
+
+    MeshCacheHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) != 0 ||
+        header.version != MESH_CACHE_VERSION ||
+        header.headerSize != sizeof(MeshCacheHeader) ||
+        header.fileSize != file.size()) {
+        return false;
+    }
+    if (header.sourceHash != sourceHash || header.flags != flags ||
+        header.vertexStride != vertexStride(layoutForFlags(flags))) {
+        std::cout << "Mesh cache out of date: " << cachePath << std::endl;
+        return false;
+    }
+    if (header.vertexOffset + (uint64_t)header.vertexCount * header.vertexStride > file.size() ||
+        (header.indexSize != sizeof(GLushort) && header.indexSize != sizeof(GLuint)) ||
+        header.indexOffset + (uint64_t)header.indexCount * header.indexSize > file.size() ||
+        header.submeshOffset + (uint64_t)header.submeshCount * sizeof(SubMesh) > file.size() ||
+        header.lodOffset + (uint64_t)header.lodCount * sizeof(MeshLod) > file.size() ||
+        header.meshletOffset + (uint64_t)header.meshletCount * sizeof(Meshlet) > file.size() ||
+        header.materialNamesOffset + header.materialNamesSize > file.size()) {
+        return false;
+    }
+    const SubMesh* submeshes = (const SubMesh*)(file.data() + header.submeshOffset);
+    for (uint32_t i = 0; i < header.submeshCount; i++) {
+        if ((uint64_t)submeshes[i].firstMeshlet + submeshes[i].meshletCount > header.meshletCount ||
+            (uint64_t)submeshes[i].indexOffset + submeshes[i].indexCount > header.indexCount ||
+            submeshes[i].material >= header.materialCount) {
+            return false;
+        }
+    }
+    const Meshlet* meshlets = (const Meshlet*)(file.data() + header.meshletOffset);
+    for (uint32_t i = 0; i < header.meshletCount; i++) {
+        if ((uint64_t)meshlets[i].indexOffset + meshlets[i].indexCount > header.indexCount) return false;
+    }
+
+    std::vector<std::string> names;
+    const char* name = (const char*)file.data() + header.materialNamesOffset;
+    const char* namesEnd = name + header.materialNamesSize;
+    while (name < namesEnd) {
+        const char* terminator = (const char*)memchr(name, '\0', namesEnd - name);
+        if (!terminator) return false;
+        names.emplace_back(name, terminator);
+        name = terminator + 1;
+    }
+    if (names.size() != (size_t)header.materialCount + 1) return false;
+    const MeshLod* lods = (const MeshLod*)(file.data() + header.lodOffset);
+    for (uint32_t i = 0; i < header.lodCount; i++) {
+        if ((uint64_t)lods[i].firstSubmesh + lods[i].submeshCount > header.submeshCount) return false;
+    }
+
+    const unsigned char* vertices = (const unsigned char*)file.data() + header.vertexOffset;
+    const unsigned char* indices = (const unsigned char*)file.data() + header.indexOffset;
+    // Un index in afara vertecsilor ar citi din mesh-ul vecin din arena
+    for (uint32_t i = 0; i < header.indexCount; i++) {
+        uint32_t index;
+        if (header.indexSize == sizeof(GLushort)) {
+            GLushort shortIndex;
+            memcpy(&shortIndex, indices + (size_t)i * sizeof(GLushort), sizeof(shortIndex));
+            index = shortIndex;
+        }
+        else {
+            memcpy(&index, indices + (size_t)i * sizeof(GLuint), sizeof(index));
+        }
+        if (index >= header.vertexCount) return false;
+    }
+    out = MeshUpload();
+    out.vertices.assign(vertices, vertices + (size_t)header.vertexCount * header.vertexStride);
+    out.indices.assign(indices, indices + (size_t)header.indexCount * header.indexSize);
+    out.indexCount = header.indexCount;
+    out.indexType = header.indexSize == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    out.layout = layoutForFlags(flags);
+
+    out.dequantization.offset = glm::vec3(header.dequantOffset[0], header.dequantOffset[1], header.dequantOffset[2]);
+    out.dequantization.scale = glm::vec3(header.dequantScale[0], header.dequantScale[1], header.dequantScale[2]);
+    out.bounds.box.min = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    out.bounds.box.max = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    out.bounds.sphere.center = glm::vec3(header.boundingSphere[0], header.boundingSphere[1], header.boundingSphere[2]);
+    out.bounds.sphere.radius = header.boundingSphere[3];
+
+    out.submeshes.assign(submeshes, submeshes + header.submeshCount);
+    out.lods.assign(lods, lods + header.lodCount);
+    out.meshlets.assign(meshlets, meshlets + header.meshletCount);
+    out.materialLibrary = names[0];
+    for (size_t i = 1; i < names.size(); i++) {
+        Material material;
+        material.name = names[i];
+        out.materials.push_back(material);
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Loaded cached mesh: " << cachePath << " (" << header.vertexCount << " vertices, "
+        << header.indexCount / 3 << " triangles) in " << ms << " ms" << std::endl;
+    return true;
+}
+
+bool writeMeshCache(const std::string& cachePath, uint64_t sourceHash, uint32_t flags, const MeshUpload& upload) {
+    if (upload.layout != layoutForFlags(flags)) return false;
+    const std::vector<unsigned char>& vertices = upload.vertices;
+    const std::vector<unsigned char>& indices = upload.indices;
+
+    MeshCacheHeader header = {};
+    memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+    header.version = MESH_CACHE_VERSION;
+    header.headerSize = sizeof(MeshCacheHeader);
+    header.sourceHash = sourceHash;
+    header.flags = flags;
+    header.vertexStride = (uint32_t)vertexStride(upload.layout);
+    header.vertexCount = (uint32_t)(vertices.size() / header.vertexStride);
+    header.indexCount = (uint32_t)upload.indexCount;
+    header.indexSize = (uint32_t)indexSize(upload.indexType);
+    header.submeshCount = (uint32_t)upload.submeshes.size();
+    header.lodCount = (uint32_t)upload.lods.size();
+    header.meshletCount = (uint32_t)upload.meshlets.size();
+    header.materialCount = (uint32_t)upload.materials.size();
+
+    std::string names = upload.materialLibrary + '\0';
+    for (const Material& material : upload.materials) names += material.name + '\0';
+    header.materialNamesSize = (uint32_t)names.size();
+
+    for (int i = 0; i < 3; i++) {
+        header.boundsMin[i] = upload.bounds.box.min[i];
+        header.boundsMax[i] = upload.bounds.box.max[i];
+        header.boundingSphere[i] = upload.bounds.sphere.center[i];
+        header.dequantOffset[i] = upload.dequantization.offset[i];
+        header.dequantScale[i] = upload.dequantization.scale[i];
+    }
+    header.boundingSphere[3] = upload.bounds.sphere.radius;
+
+    header.vertexOffset = alignUp(sizeof(MeshCacheHeader));
+    header.indexOffset = alignUp(header.vertexOffset + vertices.size());
+    header.submeshOffset = alignUp(header.indexOffset + indices.size());
+    header.lodOffset = alignUp(header.submeshOffset + upload.submeshes.size() * sizeof(SubMesh));
+    header.meshletOffset = alignUp(header.lodOffset + upload.lods.size() * sizeof(MeshLod));
+    header.materialNamesOffset = alignUp(header.meshletOffset + upload.meshlets.size() * sizeof(Meshlet));
+    header.fileSize = header.materialNamesOffset + names.size();
+
+    // Scriem intr-un fisier temporar si il redenumim, ca un cache scris pe jumatate sa nu fie citit
+    std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        const char padding[16] = {};
+        auto writeAt = [&](uint64_t offset, const void* bytes, size_t size) {
+            uint64_t position = (uint64_t)out.tellp();
+            if (offset > position) out.write(padding, (std::streamsize)(offset - position));
+            if (size) out.write((const char*)bytes, (std::streamsize)size);
+        };
+
+        writeAt(0, &header, sizeof(header));
+        writeAt(header.vertexOffset, vertices.data(), vertices.size());
+        writeAt(header.indexOffset, indices.data(), indices.size());
+        writeAt(header.submeshOffset, upload.submeshes.data(), upload.submeshes.size() * sizeof(SubMesh));
+        writeAt(header.lodOffset, upload.lods.data(), upload.lods.size() * sizeof(MeshLod));
+        writeAt(header.meshletOffset, upload.meshlets.data(), upload.meshlets.size() * sizeof(Meshlet));
+        writeAt(header.materialNamesOffset, names.data(), names.size());
+        if (!out) return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    std::cout << "Wrote mesh cache: " << cachePath << std::endl;
+    return true;
+}
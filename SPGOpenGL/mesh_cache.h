@@ -0,0 +1,21 @@
+#pragma once
+
+#include "obj_loader.hpp"
+#include <cstdint>
+#include <string>
+
+// Fisier .spgmesh: bufferele finale (vertex, index, submesh-uri cu bounds, LOD-uri, meshlet-uri, bounds, nume de materiale) exact cum sunt
+// urcate de loadOBJ, plus hash-ul continutului .obj din care au fost generate.
+// Datele sunt aliniate la 16 octeti si se citesc cu o singura copiere din maparea fisierului in MeshUpload.
+std::string meshCachePath(const std::string& sourcePath);
+
+// Etapele de procesare aplicate; un cache scris cu alte optiuni e regenerat.
+const uint32_t MESH_CACHE_OPTIMIZED = 1 << 0;
+const uint32_t MESH_CACHE_COMPACT = 1 << 1; // vertecsi in VertexLayout::Compact
+const uint32_t MESH_CACHE_LODS = 1 << 2;
+const uint32_t MESH_CACHE_MESHLETS = 1 << 3;
+const uint32_t MESH_CACHE_LEGACY_PARSER = 1 << 4; // parsat cu ObjLoadOptions::legacyParser
+
+// Nu apeleaza GL, deci merg si pe thread-urile de incarcare
+bool loadMeshCache(const std::string& cachePath, uint64_t sourceHash, uint32_t flags, MeshUpload& out);
+bool writeMeshCache(const std::string& cachePath, uint64_t sourceHash, uint32_t flags, const MeshUpload& upload);
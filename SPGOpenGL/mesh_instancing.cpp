@@ -0,0 +1,72 @@
+#include "mesh_instancing.h"
+#include <algorithm>
+
+namespace {
+    // Punctul de legare al SSBO-ului din vertex.vert (0 si 1 sunt folosite de draw_batch)
+    const GLuint INSTANCE_BUFFER_BINDING = 2;
+}
+
+bool meshInstancingSupported() {
+    return GLEW_VERSION_4_3;
+}
+
+void updateMeshInstances(MeshInstances& instances, const Mesh& mesh, const std::vector<glm::mat4>& transforms) {
+    std::vector<InstanceData> data(transforms.size());
+    for (size_t i = 0; i < transforms.size(); i++) {
+        data[i].modelMatrix = transforms[i] * mesh.positionTransform;
+        data[i].normalMatrix = glm::transpose(glm::inverse(transforms[i]));
+
+        Bounds bounds = transformBounds(mesh.bounds, transforms[i]);
+        if (i == 0) {
+            instances.bounds.box = bounds.box;
+        }
+        else {
+            instances.bounds.box.min = glm::min(instances.bounds.box.min, bounds.box.min);
+            instances.bounds.box.max = glm::max(instances.bounds.box.max, bounds.box.max);
+        }
+    }
+    instances.bounds.sphere.center = instances.bounds.box.center();
+    instances.bounds.sphere.radius = glm::length(instances.bounds.box.extent());
+
+    if (!instances.buffer) glGenBuffers(1, &instances.buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, instances.buffer);
+    if (data.size() > instances.capacity) {
+        instances.capacity = std::max(data.size(), instances.capacity * 2);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, instances.capacity * sizeof(InstanceData), nullptr, GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, data.size() * sizeof(InstanceData), data.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    instances.count = (GLsizei)data.size();
+}
+
+void drawMeshInstances(const MeshInstances& instances, const Mesh& mesh, int lod) {
+    if (instances.count == 0 || mesh.lods.empty()) return;
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BUFFER_BINDING, instances.buffer);
+
+    const MeshLod& level = mesh.lods[std::min(std::max(lod, 0), (int)mesh.lods.size() - 1)];
+    GLuint currentDiffuse = ~0u, currentNormal = ~0u;
+    for (GLuint s = level.firstSubmesh; s < level.firstSubmesh + level.submeshCount; s++) {
+        const SubMesh& submesh = mesh.submeshes[s];
+        if (submesh.material < mesh.materials.size()) {
+            const Material& material = mesh.materials[submesh.material];
+            if (material.diffuseTexture != currentDiffuse) {
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, material.diffuseTexture);
+                currentDiffuse = material.diffuseTexture;
+            }
+            if (material.normalTexture != currentNormal) {
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, material.normalTexture);
+                currentNormal = material.normalTexture;
+            }
+        }
+        // glew declara indices fara const
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, submesh.indexCount, mesh.indexType,
+            const_cast<void*>(mesh.indexOffset(submesh.indexOffset)), instances.count, mesh.baseVertex);
+    }
+}
+
+void deleteMeshInstances(MeshInstances& instances) {
+    if (instances.buffer) glDeleteBuffers(1, &instances.buffer);
+    instances = MeshInstances();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "obj_loader.hpp"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Mai multe copii ale aceluiasi Mesh desenate cu glDrawElementsInstancedBaseVertex (un apel per submesh).
+// Transformarile stau intr-un SSBO citit cu gl_InstanceID de vertex.vert compilat cu INSTANCED.
+// Necesita GL 4.3 (vezi meshInstancingSupported).
+
+// Ca InstanceData din vertex.vert (std430)
+struct InstanceData {
+    glm::mat4 modelMatrix;  // transformarea copiei * Mesh::positionTransform
+    glm::mat4 normalMatrix; // calculata pe CPU, o data pentru toate copiile
+};
+
+struct MeshInstances {
+    GLuint buffer = 0;
+    GLsizei count = 0;
+    size_t capacity = 0; // in copii
+    Bounds bounds;       // reuniunea copiilor, in spatiul lumii
+};
+
+bool meshInstancingSupported();
+
+// Urca transformarile (matricele model ale copiilor); bufferul e refolosit cat timp are loc.
+// Se apeleaza doar cand copiile se schimba.
+void updateMeshInstances(MeshInstances& instances, const Mesh& mesh, const std::vector<glm::mat4>& transforms);
+
+// Deseneaza toate copiile la nivelul lod, cu texturile materialelor pe unitatile 0 si 1.
+// Programul INSTANCED e activ, cu uniform-urile comune setate, iar VAO-ul arenei e legat.
+void drawMeshInstances(const MeshInstances& instances, const Mesh& mesh, int lod);
+
+void deleteMeshInstances(MeshInstances& instances);
@@ -0,0 +1,456 @@
+#include "mesh_lod.h"
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+
+namespace {
+    // Forma patratica simetrica 4x4 (a b c d) a planelor adunate, cu suma ponderilor separat;
+    // eroarea e media ponderata a distantelor la patrat fata de plane.
+    struct Quadric {
+        double a2 = 0, ab = 0, ac = 0, ad = 0;
+        double b2 = 0, bc = 0, bd = 0;
+        double c2 = 0, cd = 0, d2 = 0;
+        double weight = 0;
+    };
+
+    void addPlane(Quadric& q, const glm::dvec3& n, double d, double w) {
+        q.a2 += w * n.x * n.x; q.ab += w * n.x * n.y; q.ac += w * n.x * n.z; q.ad += w * n.x * d;
+        q.b2 += w * n.y * n.y; q.bc += w * n.y * n.z; q.bd += w * n.y * d;
+        q.c2 += w * n.z * n.z; q.cd += w * n.z * d;
+        q.d2 += w * d * d;
+        q.weight += w;
+    }
+
+    Quadric sumQuadrics(const Quadric& q, const Quadric& r) {
+        Quadric s;
+        s.a2 = q.a2 + r.a2; s.ab = q.ab + r.ab; s.ac = q.ac + r.ac; s.ad = q.ad + r.ad;
+        s.b2 = q.b2 + r.b2; s.bc = q.bc + r.bc; s.bd = q.bd + r.bd;
+        s.c2 = q.c2 + r.c2; s.cd = q.cd + r.cd; s.d2 = q.d2 + r.d2;
+        s.weight = q.weight + r.weight;
+        return s;
+    }
+
+    double quadricError(const Quadric& q, const glm::dvec3& p) {
+        if (q.weight <= 0) return 0;
+        double r = q.a2 * p.x * p.x + q.b2 * p.y * p.y + q.c2 * p.z * p.z
+            + 2 * (q.ab * p.x * p.y + q.ac * p.x * p.z + q.bc * p.y * p.z)
+            + 2 * (q.ad * p.x + q.bd * p.y + q.cd * p.z) + q.d2;
+        return std::max(r, 0.0) / q.weight;
+    }
+
+    // Planul perpendicular pe o muchie de margine; ponderea mare tine marginile pe loc
+    const double BORDER_WEIGHT = 10.0;
+
+    struct PositionKey {
+        uint32_t bits[3];
+        bool operator==(const PositionKey& o) const { return memcmp(bits, o.bits, sizeof(bits)) == 0; }
+    };
+
+    struct PositionKeyHash {
+        size_t operator()(const PositionKey& k) const {
+            uint64_t h = k.bits[0] * 0x9E3779B97F4A7C15ull;
+            h ^= (k.bits[1] + 0x632BE59BD9B4E019ull) + (h << 6) + (h >> 2);
+            h ^= (k.bits[2] + 0x85EBCA77C2B2AE63ull) + (h << 6) + (h >> 2);
+            return (size_t)h;
+        }
+    };
+
+    enum VertexKind : char {
+        VERTEX_INTERIOR,
+        VERTEX_BORDER,
+        VERTEX_LOCKED, // muchii non-manifold sau margini care se ating intr-un punct
+    };
+
+    struct Collapse {
+        GLuint from, to;
+        double cost;
+    };
+
+    // Liste CSR: elementele grupului g sunt items[offsets[g] .. offsets[g + 1])
+    struct Adjacency {
+        std::vector<GLuint> offsets;
+        std::vector<GLuint> items;
+    };
+}
+
+size_t simplifyMesh(GLuint* destination, const GLuint* indices, size_t indexCount,
+    const float* vertexData, size_t vertexCount, size_t targetIndexCount, float targetError, float* error) {
+    if (error) *error = 0.0f;
+    std::vector<GLuint> triangles(indices, indices + indexCount / 3 * 3);
+    if (triangles.size() <= targetIndexCount || vertexCount == 0) {
+        std::copy(triangles.begin(), triangles.end(), destination);
+        return triangles.size();
+    }
+
+    // Vertecsii cu aceeasi pozitie (cusaturi de UV/normale) se misca impreuna: topologia si
+    // quadricele sunt pe pozitii unice, iar triunghiurile raman in indici de vertex.
+    glm::vec3 lo(vertexData[0], vertexData[1], vertexData[2]), hi = lo;
+    for (size_t v = 0; v < vertexCount; v++) {
+        const float* p = vertexData + v * MESH_VERTEX_FLOATS;
+        lo = glm::min(lo, glm::vec3(p[0], p[1], p[2]));
+        hi = glm::max(hi, glm::vec3(p[0], p[1], p[2]));
+    }
+    double extent = std::max({ hi.x - lo.x, hi.y - lo.y, hi.z - lo.z });
+    if (extent <= 0) extent = 1;
+
+    std::vector<GLuint> positionOf(vertexCount);
+    std::vector<glm::dvec3> points;
+    {
+        std::unordered_map<PositionKey, GLuint, PositionKeyHash> welded;
+        welded.reserve(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++) {
+            const float* p = vertexData + v * MESH_VERTEX_FLOATS;
+            PositionKey key;
+            float position[3] = { p[0] + 0.0f, p[1] + 0.0f, p[2] + 0.0f }; // -0 si +0 sunt aceeasi pozitie
+            memcpy(key.bits, position, sizeof(key.bits));
+            auto inserted = welded.emplace(key, (GLuint)points.size());
+            if (inserted.second) points.push_back((glm::dvec3(p[0], p[1], p[2]) - glm::dvec3(lo)) / extent);
+            positionOf[v] = inserted.first->second;
+        }
+    }
+    size_t positionCount = points.size();
+
+    auto trianglePosition = [&](size_t t, int k) { return positionOf[triangles[t * 3 + k]]; };
+
+    // Triunghiurile degenerate in spatiul pozitiilor (de ex. la polii unei sfere UV) nu se vad
+    auto removeDegenerate = [&]() {
+        size_t write = 0;
+        for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+            GLuint a = triangles[i], b = triangles[i + 1], c = triangles[i + 2];
+            if (positionOf[a] == positionOf[b] || positionOf[b] == positionOf[c] || positionOf[c] == positionOf[a]) continue;
+            triangles[write++] = a;
+            triangles[write++] = b;
+            triangles[write++] = c;
+        }
+        triangles.resize(write);
+    };
+    removeDegenerate();
+
+    Adjacency positionTriangles, positionWedges;
+    auto buildAdjacency = [&](Adjacency& adjacency, size_t groups, auto&& forEach) {
+        adjacency.offsets.assign(groups + 1, 0);
+        forEach([&](GLuint group, GLuint) { adjacency.offsets[group + 1]++; });
+        for (size_t g = 0; g < groups; g++) adjacency.offsets[g + 1] += adjacency.offsets[g];
+        adjacency.items.resize(adjacency.offsets[groups]);
+        std::vector<GLuint> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+        forEach([&](GLuint group, GLuint item) { adjacency.items[fill[group]++] = item; });
+    };
+    auto buildTriangleAdjacency = [&]() {
+        buildAdjacency(positionTriangles, positionCount, [&](auto&& emit) {
+            for (size_t t = 0; t < triangles.size() / 3; t++) {
+                for (int k = 0; k < 3; k++) emit(trianglePosition(t, k), (GLuint)t);
+            }
+        });
+    };
+
+    // Numarul de triunghiuri care contin muchia orientata a -> b
+    auto countEdge = [&](GLuint a, GLuint b) {
+        GLuint count = 0;
+        for (GLuint i = positionTriangles.offsets[a]; i < positionTriangles.offsets[a + 1]; i++) {
+            size_t t = positionTriangles.items[i];
+            for (int k = 0; k < 3; k++) {
+                if (trianglePosition(t, k) == a && trianglePosition(t, (k + 1) % 3) == b) count++;
+            }
+        }
+        return count;
+    };
+    auto isBorderEdge = [&](GLuint a, GLuint b) {
+        return countEdge(a, b) + countEdge(b, a) == 1;
+    };
+
+    buildTriangleAdjacency();
+
+    // Quadricele initiale: planele triunghiurilor ponderate cu aria, plus planele de margine
+    std::vector<Quadric> quadrics(positionCount);
+    for (size_t t = 0; t < triangles.size() / 3; t++) {
+        GLuint a = trianglePosition(t, 0), b = trianglePosition(t, 1), c = trianglePosition(t, 2);
+        glm::dvec3 normal = glm::cross(points[b] - points[a], points[c] - points[a]);
+        double length = glm::length(normal);
+        if (length <= 0) continue;
+        normal /= length;
+
+        double area = length * 0.5;
+        double d = -glm::dot(normal, points[a]);
+        for (int k = 0; k < 3; k++) addPlane(quadrics[trianglePosition(t, k)], normal, d, area);
+
+        for (int k = 0; k < 3; k++) {
+            GLuint from = trianglePosition(t, k), to = trianglePosition(t, (k + 1) % 3);
+            if (countEdge(to, from)) continue;
+
+            glm::dvec3 edge = points[to] - points[from];
+            glm::dvec3 borderNormal = glm::cross(edge, normal);
+            double borderLength = glm::length(borderNormal);
+            if (borderLength <= 0) continue;
+            borderNormal /= borderLength;
+            double borderD = -glm::dot(borderNormal, points[from]);
+            double weight = glm::dot(edge, edge) * BORDER_WEIGHT;
+            addPlane(quadrics[from], borderNormal, borderD, weight);
+            addPlane(quadrics[to], borderNormal, borderD, weight);
+        }
+    }
+
+    double maxCost = (double)targetError / extent;
+    maxCost *= maxCost;
+    double resultCost = 0;
+
+    std::vector<char> kind(positionCount);
+    std::vector<char> locked(positionCount);
+    std::vector<char> wedgeSeen(vertexCount);
+    std::vector<GLuint> remap(vertexCount);
+    std::vector<Collapse> collapses;
+    size_t overscan = 2;
+
+    while (triangles.size() > targetIndexCount) {
+        size_t triangleCount = triangles.size() / 3;
+
+        // Tipul fiecarei pozitii dupa muchiile incidente
+        for (size_t p = 0; p < positionCount; p++) {
+            int borderEdges = 0;
+            bool nonManifold = false;
+            for (GLuint i = positionTriangles.offsets[p]; i < positionTriangles.offsets[p + 1]; i++) {
+                size_t t = positionTriangles.items[i];
+                int k = trianglePosition(t, 0) == p ? 0 : trianglePosition(t, 1) == p ? 1 : 2;
+                GLuint next = trianglePosition(t, (k + 1) % 3), previous = trianglePosition(t, (k + 2) % 3);
+                nonManifold |= countEdge((GLuint)p, next) > 1;
+                borderEdges += countEdge(next, (GLuint)p) == 0;
+                borderEdges += countEdge((GLuint)p, previous) == 0;
+            }
+            kind[p] = nonManifold || (borderEdges != 0 && borderEdges != 2) ? VERTEX_LOCKED
+                : borderEdges == 2 ? VERTEX_BORDER : VERTEX_INTERIOR;
+        }
+
+        buildAdjacency(positionWedges, positionCount, [&](auto&& emit) {
+            std::fill(wedgeSeen.begin(), wedgeSeen.end(), 0);
+            for (GLuint v : triangles) {
+                if (wedgeSeen[v]) continue;
+                wedgeSeen[v] = 1;
+                emit(positionOf[v], v);
+            }
+        });
+
+        // Candidati: pentru fiecare muchie, directia cu eroarea mai mica
+        collapses.clear();
+        auto canCollapse = [&](GLuint from, GLuint to) {
+            if (kind[from] == VERTEX_LOCKED) return false;
+            if (kind[from] == VERTEX_BORDER) return kind[to] != VERTEX_INTERIOR && isBorderEdge(from, to);
+            return true;
+        };
+        for (size_t t = 0; t < triangleCount; t++) {
+            for (int k = 0; k < 3; k++) {
+                GLuint a = trianglePosition(t, k), b = trianglePosition(t, (k + 1) % 3);
+                if (a > b && countEdge(b, a)) continue; // muchie interioara, vazuta o data
+
+                Quadric q = sumQuadrics(quadrics[a], quadrics[b]);
+                Collapse best = { 0, 0, -1 };
+                if (canCollapse(a, b)) best = { a, b, quadricError(q, points[b]) };
+                if (canCollapse(b, a)) {
+                    double cost = quadricError(q, points[a]);
+                    if (best.cost < 0 || cost < best.cost) best = { b, a, cost };
+                }
+                if (best.cost >= 0 && best.cost <= maxCost) collapses.push_back(best);
+            }
+        }
+        // Doar cele mai ieftine colapsari de care mai e nevoie (cu rezerva pentru cele respinse);
+        // restul se reevalueaza in trecerile urmatoare
+        auto cheaper = [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; };
+        size_t candidateCount = collapses.size();
+        size_t considered = std::min(candidateCount, (triangleCount - targetIndexCount / 3) * overscan);
+        std::nth_element(collapses.begin(), collapses.begin() + considered, collapses.end(), cheaper);
+        collapses.resize(considered);
+        std::sort(collapses.begin(), collapses.end(), cheaper);
+
+        for (size_t v = 0; v < vertexCount; v++) remap[v] = (GLuint)v;
+        std::fill(locked.begin(), locked.end(), 0);
+
+        size_t remaining = triangleCount;
+        size_t performed = 0;
+        for (const Collapse& collapse : collapses) {
+            if (remaining * 3 <= targetIndexCount) break;
+            GLuint from = collapse.from, to = collapse.to;
+            if (locked[from] || locked[to]) continue;
+
+            // Fiecare vertex al pozitiei from trebuie sa aiba o muchie spre un vertex al lui to;
+            // altfel colapsarea ar strica o cusatura de UV/normale.
+            bool valid = true;
+            for (GLuint w = positionWedges.offsets[from]; valid && w < positionWedges.offsets[from + 1]; w++) {
+                GLuint wedge = positionWedges.items[w];
+                GLuint target = wedge;
+                for (GLuint i = positionTriangles.offsets[from]; i < positionTriangles.offsets[from + 1]; i++) {
+                    const GLuint* tri = &triangles[(size_t)positionTriangles.items[i] * 3];
+                    if (tri[0] != wedge && tri[1] != wedge && tri[2] != wedge) continue;
+                    for (int k = 0; k < 3; k++) {
+                        if (positionOf[tri[k]] == to) target = tri[k];
+                    }
+                    if (target != wedge) break;
+                }
+                valid = target != wedge;
+            }
+            if (!valid) continue;
+
+            // Triunghiurile care raman nu au voie sa se intoarca
+            size_t removed = 0;
+            for (GLuint i = positionTriangles.offsets[from]; valid && i < positionTriangles.offsets[from + 1]; i++) {
+                size_t t = positionTriangles.items[i];
+                glm::dvec3 corners[3];
+                bool hasTo = false;
+                for (int k = 0; k < 3; k++) {
+                    GLuint p = trianglePosition(t, k);
+                    hasTo |= p == to;
+                    corners[k] = points[p];
+                }
+                if (hasTo) {
+                    removed++;
+                    continue;
+                }
+                glm::dvec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                for (int k = 0; k < 3; k++) {
+                    if (trianglePosition(t, k) == from) corners[k] = points[to];
+                }
+                glm::dvec3 after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                valid = glm::dot(before, after) > 0;
+            }
+            if (!valid) continue;
+
+            for (GLuint w = positionWedges.offsets[from]; w < positionWedges.offsets[from + 1]; w++) {
+                GLuint wedge = positionWedges.items[w];
+                for (GLuint i = positionTriangles.offsets[from]; i < positionTriangles.offsets[from + 1]; i++) {
+                    const GLuint* tri = &triangles[(size_t)positionTriangles.items[i] * 3];
+                    if (tri[0] != wedge && tri[1] != wedge && tri[2] != wedge) continue;
+                    for (int k = 0; k < 3; k++) {
+                        if (positionOf[tri[k]] == to) remap[wedge] = tri[k];
+                    }
+                    if (remap[wedge] != wedge) break;
+                }
+            }
+            quadrics[to] = sumQuadrics(quadrics[to], quadrics[from]);
+            resultCost = std::max(resultCost, collapse.cost);
+
+            // Vecinii ambelor capete nu mai colapseaza in aceasta trecere (adiacenta ar fi invechita)
+            for (GLuint end : { from, to }) {
+                for (GLuint i = positionTriangles.offsets[end]; i < positionTriangles.offsets[end + 1]; i++) {
+                    for (int k = 0; k < 3; k++) locked[trianglePosition(positionTriangles.items[i], k)] = 1;
+                }
+            }
+            remaining -= removed;
+            performed++;
+        }
+
+        // Daca aproape toate candidatele alese au fost respinse, trecerea urmatoare se uita la mai multe;
+        // daca s-au incercat deja toate, simplificarea s-a blocat
+        bool stalled = (triangleCount - remaining) * 100 < triangleCount;
+        if (stalled && considered < candidateCount) overscan *= 4;
+        if (performed == 0) {
+            if (considered == candidateCount) break;
+            continue;
+        }
+
+        for (GLuint& v : triangles) v = remap[v];
+        removeDegenerate();
+        buildTriangleAdjacency();
+        if (stalled && considered == candidateCount) break;
+    }
+
+    if (error) *error = (float)(std::sqrt(resultCost) * extent);
+    std::copy(triangles.begin(), triangles.end(), destination);
+    return triangles.size();
+}
+
+void buildMeshLods(MeshData& data, const std::string& name) {
+    size_t vertexCount = data.vertexData.size() / MESH_VERTEX_FLOATS;
+    if (data.lods.empty() || vertexCount == 0) return;
+
+    auto start = std::chrono::steady_clock::now();
+    glm::vec3 size = data.bounds.box.max - data.bounds.box.min;
+    float maxError = MESH_LOD_MAX_RELATIVE_ERROR * std::max({ size.x, size.y, size.z });
+
+    const MeshLod base = data.lods[0];
+    size_t previousTriangles = 0;
+    for (GLuint s = 0; s < base.submeshCount; s++) previousTriangles += data.submeshes[base.firstSubmesh + s].indexCount / 3;
+
+    std::cout << "LODs for " << name << ": " << previousTriangles;
+
+    std::vector<GLuint> simplified;
+    for (int level = 1; level < MAX_MESH_LODS; level++) {
+        MeshLod lod = { (GLuint)data.submeshes.size(), base.submeshCount, 0.0f };
+        std::vector<SubMesh> levelSubmeshes;
+        std::vector<GLuint> levelIndices;
+        size_t levelTriangles = 0;
+
+        for (GLuint s = 0; s < base.submeshCount; s++) {
+            const SubMesh source = data.submeshes[base.firstSubmesh + s];
+            size_t target = (size_t)std::ldexp((double)(source.indexCount / 3), -level) * 3;
+
+            simplified.resize(source.indexCount);
+            float error = 0.0f;
+            size_t count = simplifyMesh(simplified.data(), data.indices.data() + source.indexOffset, source.indexCount,
+                data.vertexData.data(), vertexCount, target, maxError, &error);
+
+            // bounds e calculat de computeMeshBounds, dupa ce sunt adaugate toate nivelurile
+            SubMesh submesh;
+            submesh.indexOffset = (GLuint)(data.indices.size() + levelIndices.size());
+            submesh.indexCount = (GLuint)count;
+            submesh.material = source.material;
+            levelSubmeshes.push_back(submesh);
+            levelIndices.insert(levelIndices.end(), simplified.begin(), simplified.begin() + count);
+            levelTriangles += count / 3;
+            lod.error = std::max(lod.error, error);
+        }
+
+        // Un nivel care aproape nu reduce geometria nu merita memoria
+        if (levelTriangles == 0 || levelTriangles * 100 > previousTriangles * 85) break;
+
+        data.indices.insert(data.indices.end(), levelIndices.begin(), levelIndices.end());
+        data.submeshes.insert(data.submeshes.end(), levelSubmeshes.begin(), levelSubmeshes.end());
+        data.lods.push_back(lod);
+        previousTriangles = levelTriangles;
+
+        std::cout << " -> " << levelTriangles << " (error " << lod.error << ")";
+    }
+    computeMeshBounds(data);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << " triangles in " << ms << " ms" << std::endl;
+}
+
+int selectMeshLod(const Mesh& mesh, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection,
+    float viewportHeight, float lodBias) {
+    if (mesh.lods.size() < 2) return 0;
+
+    glm::vec3 center = mesh.bounds.sphere.center;
+    float radius = mesh.bounds.sphere.radius;
+    float scale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+
+    float pixelsPerUnit = projection[1][1] * viewportHeight * 0.5f;
+    // In perspectiva eroarea scade cu distanta pana la cel mai apropiat punct al sferei
+    if (projection[2][3] != 0.0f) {
+        glm::vec3 viewCenter = glm::vec3(view * model * glm::vec4(center, 1.0f));
+        float distance = glm::length(viewCenter) - radius * scale;
+        if (distance <= 0.0f) return 0;
+        pixelsPerUnit /= distance;
+    }
+
+    float threshold = MESH_LOD_PIXEL_ERROR * std::exp2(lodBias);
+    int lod = 0;
+    for (int i = 1; i < (int)mesh.lods.size(); i++) {
+        if (mesh.lods[i].error * scale * pixelsPerUnit <= threshold) lod = i;
+    }
+    return lod;
+}
+
+void drawMeshLod(const Mesh& mesh, int lod) {
+    if (mesh.lods.empty()) {
+        glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)mesh.indexCount, mesh.indexType,
+            const_cast<void*>(mesh.indexOffset(0)), mesh.baseVertex);
+    }
+    else {
+        const MeshLod& level = mesh.lods[std::min(std::max(lod, 0), (int)mesh.lods.size() - 1)];
+        for (GLuint s = level.firstSubmesh; s < level.firstSubmesh + level.submeshCount; s++) {
+            const SubMesh& submesh = mesh.submeshes[s];
+            glDrawElementsBaseVertex(GL_TRIANGLES, submesh.indexCount, mesh.indexType,
+                const_cast<void*>(mesh.indexOffset(submesh.indexOffset)), mesh.baseVertex);
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "obj_loader.hpp"
+#include <string>
+
+// Niveluri de detaliu generate la incarcare. Simplificarea lucreaza doar pe index buffer:
+// vertecsii colapsati sunt inlocuiti cu vertecsi existenti, deci toate LOD-urile impart acelasi VBO
+// si fiecare nivel e doar un alt set de submesh-uri in acelasi EBO.
+
+const int MAX_MESH_LODS = 5;
+// Eroarea maxima la care se mai genereaza un nivel, relativa la cea mai mare latura a AABB-ului
+const float MESH_LOD_MAX_RELATIVE_ERROR = 0.05f;
+// Eroarea geometrica maxima acceptata pe ecran, in pixeli, pentru lodBias = 0
+const float MESH_LOD_PIXEL_ERROR = 1.0f;
+
+// Colapsare de muchii cu metrica de eroare quadrica (Garland & Heckbert 1997), pana la
+// targetIndexCount indici sau pana cand eroarea ar depasi targetError (in unitatile modelului).
+// Marginile deschise si cusaturile de UV/normale se pastreaza. Scrie in destination (cel putin
+// indexCount elemente) si returneaza numarul de indici; error primeste eroarea atinsa.
+size_t simplifyMesh(GLuint* destination, const GLuint* indices, size_t indexCount,
+    const float* vertexData, size_t vertexCount, size_t targetIndexCount, float targetError, float* error = nullptr);
+
+// Adauga in data lantul de LOD-uri (fiecare cu ~jumatate din triunghiurile nivelului anterior),
+// simplificate mereu din nivelul 0. Se opreste cand simplificarea nu mai reduce geometria.
+void buildMeshLods(MeshData& data, const std::string& name);
+
+// Cel mai simplu LOD a carui eroare proiectata e sub MESH_LOD_PIXEL_ERROR * 2^lodBias.
+// Functioneaza si cu proiectii ortografice (umbra soarelui).
+int selectMeshLod(const Mesh& mesh, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection,
+    float viewportHeight, float lodBias = 0.0f);
+
+// Deseneaza submesh-urile unui LOD; VAO-ul arenei trebuie sa fie deja legat (bindGeometryArena)
+void drawMeshLod(const Mesh& mesh, int lod);
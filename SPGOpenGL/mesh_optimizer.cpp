@@ -0,0 +1,277 @@
+#include "mesh_optimizer.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    // Cache FIFO de dimensiune fixa; timestamp-uri in loc de coada explicita.
+    class FifoCache {
+    public:
+        FifoCache(size_t vertexCount, unsigned size) : stamps(vertexCount, 0), size(size), time(size + 1) {}
+
+        // true daca vertexul a trebuit transformat (miss)
+        bool access(GLuint v) {
+            if (time - stamps[v] > size) {
+                stamps[v] = time++;
+                return true;
+            }
+            return false;
+        }
+
+        void reset() { time += size + 1; }
+
+    private:
+        std::vector<unsigned> stamps;
+        unsigned size;
+        unsigned time;
+    };
+
+    glm::vec3 vertexPosition(const float* vertexData, GLuint v) {
+        const float* p = vertexData + (size_t)v * MESH_VERTEX_FLOATS;
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+
+    struct Cluster {
+        size_t firstTriangle;
+        size_t triangleCount;
+        float sortKey;
+    };
+}
+
+VertexCacheStats analyzeVertexCache(const GLuint* indices, size_t indexCount, size_t vertexCount, unsigned cacheSize) {
+    VertexCacheStats stats = { 0.0f, 0.0f };
+    if (indexCount < 3 || vertexCount == 0) return stats;
+
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<char> used(vertexCount, 0);
+    size_t misses = 0, unique = 0;
+    for (size_t i = 0; i < indexCount; i++) {
+        if (cache.access(indices[i])) misses++;
+        if (!used[indices[i]]) {
+            used[indices[i]] = 1;
+            unique++;
+        }
+    }
+
+    stats.acmr = (float)misses / (indexCount / 3);
+    stats.atvr = (float)misses / unique;
+    return stats;
+}
+
+void optimizeVertexCache(GLuint* indices, size_t indexCount, size_t vertexCount, unsigned cacheSize) {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) return;
+
+    // Adiacenta vertex -> triunghiuri (CSR)
+    std::vector<unsigned> liveTriangles(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++) liveTriangles[indices[i]]++;
+
+    std::vector<size_t> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) adjacencyOffset[v + 1] = adjacencyOffset[v] + liveTriangles[v];
+    std::vector<unsigned> adjacency(adjacencyOffset[vertexCount]);
+    {
+        std::vector<size_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (size_t t = 0; t < triangleCount; t++) {
+            for (int k = 0; k < 3; k++) adjacency[fill[indices[t * 3 + k]]++] = (unsigned)t;
+        }
+    }
+
+    std::vector<unsigned> cacheTime(vertexCount, 0);
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<GLuint> deadEnd;
+    std::vector<GLuint> candidates;
+    std::vector<GLuint> output;
+    output.reserve(triangleCount * 3);
+
+    unsigned time = cacheSize + 1;
+    size_t cursor = 0;
+
+    auto skipDeadEnd = [&]() -> long long {
+        while (!deadEnd.empty()) {
+            GLuint d = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[d] > 0) return d;
+        }
+        while (cursor < vertexCount) {
+            if (liveTriangles[cursor] > 0) return (long long)cursor++;
+            cursor++;
+        }
+        return -1;
+    };
+
+    long long fanning = skipDeadEnd();
+    while (fanning >= 0) {
+        candidates.clear();
+
+        for (size_t a = adjacencyOffset[fanning]; a < adjacencyOffset[fanning + 1]; a++) {
+            unsigned t = adjacency[a];
+            if (emitted[t]) continue;
+            emitted[t] = 1;
+
+            for (int k = 0; k < 3; k++) {
+                GLuint v = indices[t * 3 + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if (time - cacheTime[v] > cacheSize) {
+                    cacheTime[v] = time++;
+                }
+            }
+        }
+
+        // Urmatorul vertex de evantai: cel care ramane in cache si are cele mai multe triunghiuri ramase
+        long long next = -1;
+        int best = -1;
+        for (GLuint v : candidates) {
+            if (liveTriangles[v] == 0) continue;
+            int priority = 0;
+            if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize) priority = (int)(time - cacheTime[v]);
+            if (priority > best) {
+                best = priority;
+                next = v;
+            }
+        }
+        fanning = next >= 0 ? next : skipDeadEnd();
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void optimizeOverdraw(GLuint* indices, size_t indexCount, const float* vertexData, size_t vertexCount,
+    unsigned cacheSize, float threshold) {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2) return;
+
+    // Granite "dure": triunghiuri la care cache-ul rateaza toti cei trei vertecsi
+    std::vector<size_t> hardBoundaries;
+    {
+        FifoCache cache(vertexCount, cacheSize);
+        for (size_t t = 0; t < triangleCount; t++) {
+            int misses = 0;
+            for (int k = 0; k < 3; k++) misses += cache.access(indices[t * 3 + k]);
+            if (t == 0 || misses == 3) hardBoundaries.push_back(t);
+        }
+        hardBoundaries.push_back(triangleCount);
+    }
+
+    // Granite "moi": in interiorul fiecarui cluster dur, taiem acolo unde ACMR-ul de pana atunci
+    // (cu cache-ul golit la inceputul clusterului) e deja sub threshold * ACMR-ul clusterului
+    std::vector<Cluster> clusters;
+    FifoCache cache(vertexCount, cacheSize);
+    for (size_t c = 0; c + 1 < hardBoundaries.size(); c++) {
+        size_t begin = hardBoundaries[c], end = hardBoundaries[c + 1];
+
+        cache.reset();
+        size_t clusterMisses = 0;
+        for (size_t t = begin; t < end; t++) {
+            for (int k = 0; k < 3; k++) clusterMisses += cache.access(indices[t * 3 + k]);
+        }
+        float clusterThreshold = threshold * (float)clusterMisses / (end - begin);
+
+        cache.reset();
+        size_t start = begin, misses = 0;
+        for (size_t t = begin; t < end; t++) {
+            for (int k = 0; k < 3; k++) misses += cache.access(indices[t * 3 + k]);
+            size_t count = t + 1 - start;
+            if (t + 1 < end && (float)misses / count <= clusterThreshold) {
+                clusters.push_back({ start, count, 0.0f });
+                start = t + 1;
+                misses = 0;
+                cache.reset();
+            }
+        }
+        clusters.push_back({ start, end - start, 0.0f });
+    }
+
+    if (clusters.size() < 2) return;
+
+    // Centroid ponderat cu aria pentru tot submesh-ul
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (size_t t = 0; t < triangleCount; t++) {
+        glm::vec3 a = vertexPosition(vertexData, indices[t * 3]);
+        glm::vec3 b = vertexPosition(vertexData, indices[t * 3 + 1]);
+        glm::vec3 c = vertexPosition(vertexData, indices[t * 3 + 2]);
+        float area = glm::length(glm::cross(b - a, c - a));
+        meshCentroid += (a + b + c) * (area / 3.0f);
+        meshArea += area;
+    }
+    meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : glm::vec3(0.0f);
+
+    // Clusterele ale caror normale medii privesc dinspre centru spre exterior se deseneaza primele
+    for (Cluster& cluster : clusters) {
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = cluster.firstTriangle; t < cluster.firstTriangle + cluster.triangleCount; t++) {
+            glm::vec3 a = vertexPosition(vertexData, indices[t * 3]);
+            glm::vec3 b = vertexPosition(vertexData, indices[t * 3 + 1]);
+            glm::vec3 c = vertexPosition(vertexData, indices[t * 3 + 2]);
+            glm::vec3 n = glm::cross(b - a, c - a);
+            float triangleArea = glm::length(n);
+            centroid += (a + b + c) * (triangleArea / 3.0f);
+            normal += n;
+            area += triangleArea;
+        }
+        if (area > 0.0f) centroid /= area;
+        float normalLength = glm::length(normal);
+        if (normalLength > 0.0f) normal /= normalLength;
+        cluster.sortKey = glm::dot(centroid - meshCentroid, normal);
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<GLuint> sorted;
+    sorted.reserve(triangleCount * 3);
+    for (const Cluster& cluster : clusters) {
+        sorted.insert(sorted.end(), indices + cluster.firstTriangle * 3,
+            indices + (cluster.firstTriangle + cluster.triangleCount) * 3);
+    }
+    std::copy(sorted.begin(), sorted.end(), indices);
+}
+
+void optimizeVertexFetch(MeshData& data) {
+    size_t vertexCount = data.vertexData.size() / MESH_VERTEX_FLOATS;
+    const GLuint unassigned = ~0u;
+    std::vector<GLuint> remap(vertexCount, unassigned);
+
+    GLuint next = 0;
+    for (GLuint& index : data.indices) {
+        if (remap[index] == unassigned) remap[index] = next++;
+        index = remap[index];
+    }
+    // Vertecsii nefolositi raman la final, in ordinea initiala
+    for (size_t v = 0; v < vertexCount; v++) {
+        if (remap[v] == unassigned) remap[v] = next++;
+    }
+
+    std::vector<float> reordered(data.vertexData.size());
+    for (size_t v = 0; v < vertexCount; v++) {
+        std::copy(data.vertexData.begin() + v * MESH_VERTEX_FLOATS, data.vertexData.begin() + (v + 1) * MESH_VERTEX_FLOATS,
+            reordered.begin() + (size_t)remap[v] * MESH_VERTEX_FLOATS);
+    }
+    data.vertexData.swap(reordered);
+}
+
+void optimizeMesh(MeshData& data, const std::string& name) {
+    size_t vertexCount = data.vertexData.size() / MESH_VERTEX_FLOATS;
+    if (data.indices.empty() || vertexCount == 0) return;
+
+    auto start = std::chrono::steady_clock::now();
+    VertexCacheStats before = analyzeVertexCache(data.indices.data(), data.indices.size(), vertexCount);
+
+    for (const SubMesh& submesh : data.submeshes) {
+        GLuint* indices = data.indices.data() + submesh.indexOffset;
+        optimizeVertexCache(indices, submesh.indexCount, vertexCount);
+        optimizeOverdraw(indices, submesh.indexCount, data.vertexData.data(), vertexCount);
+    }
+    optimizeVertexFetch(data);
+
+    VertexCacheStats after = analyzeVertexCache(data.indices.data(), data.indices.size(), vertexCount);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Optimized " << name << " in " << ms << " ms: ACMR " << before.acmr << " -> " << after.acmr
+        << ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "obj_loader.hpp"
+#include <string>
+
+// Optimizari pe CPU ale bufferelor unui mesh, aplicate la incarcare inainte de upload.
+// Toate functiile lucreaza pe submesh-uri separat, deci intervalele din MeshData::submeshes raman valide.
+
+// Statistici pentru un cache post-transform FIFO simulat.
+// ACMR = vertecsi transformati / triunghi, ATVR = vertecsi transformati / vertex unic.
+struct VertexCacheStats {
+    float acmr;
+    float atvr;
+};
+
+VertexCacheStats analyzeVertexCache(const GLuint* indices, size_t indexCount, size_t vertexCount, unsigned cacheSize = 16);
+
+// Reordonare de triunghiuri Tipsify (Sander et al. 2007) pentru localitate in cache.
+void optimizeVertexCache(GLuint* indices, size_t indexCount, size_t vertexCount, unsigned cacheSize = 16);
+
+// Imparte ordinea data de optimizeVertexCache in clustere si le sorteaza astfel incat
+// cele orientate spre exterior sa fie desenate primele (mai putin overdraw).
+// threshold > 1 permite clustere mai mici cu pretul unui ACMR putin mai mare.
+void optimizeOverdraw(GLuint* indices, size_t indexCount, const float* vertexData, size_t vertexCount,
+    unsigned cacheSize = 16, float threshold = 1.05f);
+
+// Renumeroteaza vertecsii in ordinea primei folosiri si rearanjeaza vertexData in consecinta.
+void optimizeVertexFetch(MeshData& data);
+
+// Cele trei etape de mai sus pe fiecare submesh, cu raport ACMR/ATVR inainte si dupa.
+void optimizeMesh(MeshData& data, const std::string& name);
@@ -0,0 +1,168 @@
+#include "mesh_streaming.h"
+#include "geometry_arena.h"
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct StreamRequest {
+        std::string path;
+        ObjLoadOptions options;
+        Mesh* target;
+        std::function<void(Mesh&)> onReady;
+        std::chrono::steady_clock::time_point requested;
+    };
+
+    // Rezultatul unui thread de incarcare, urcat apoi pe bucati de thread-ul GL
+    struct StagedMesh {
+        StreamRequest request;
+        MeshUpload upload;
+        bool ok = false;
+        Mesh mesh = {};
+        bool created = false;
+        size_t vertexBytesDone = 0, indexBytesDone = 0;
+    };
+
+    struct MeshStreamer {
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<StreamRequest> requests;
+        std::deque<std::unique_ptr<StagedMesh>> ready;
+        std::vector<std::thread> workers;
+        bool stopping = false;
+        std::atomic<size_t> pending{ 0 };
+
+        // Folosit doar de thread-ul GL
+        std::unique_ptr<StagedMesh> uploading;
+
+        ~MeshStreamer() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (std::thread& worker : workers) worker.join();
+        }
+
+        void work() {
+            for (;;) {
+                StreamRequest request;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock, [this] { return stopping || !requests.empty(); });
+                    if (stopping) return;
+                    request = std::move(requests.front());
+                    requests.pop_front();
+                }
+
+                std::unique_ptr<StagedMesh> staged(new StagedMesh());
+                staged->ok = prepareOBJ(request.path, request.options, staged->upload);
+                staged->request = std::move(request);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                ready.push_back(std::move(staged));
+            }
+        }
+    };
+
+    MeshStreamer& streamer() {
+        static MeshStreamer instance;
+        return instance;
+    }
+
+    // Trimite urmatoarea bucata de vertecsi sau indici in arena; true cand ambele sunt complete
+    bool uploadSlice(StagedMesh& staged) {
+        const MeshUpload& upload = staged.upload;
+        if (staged.vertexBytesDone < upload.vertices.size()) {
+            size_t size = std::min(MESH_UPLOAD_SLICE_BYTES, upload.vertices.size() - staged.vertexBytesDone);
+            size_t base = (size_t)staged.mesh.baseVertex * vertexStride(upload.layout);
+            writeGeometryVertices(base + staged.vertexBytesDone, upload.vertices.data() + staged.vertexBytesDone, size);
+            staged.vertexBytesDone += size;
+        }
+        else if (staged.indexBytesDone < upload.indices.size()) {
+            size_t size = std::min(MESH_UPLOAD_SLICE_BYTES, upload.indices.size() - staged.indexBytesDone);
+            writeGeometryIndices(staged.mesh.firstIndexByte + staged.indexBytesDone, upload.indices.data() + staged.indexBytesDone, size);
+            staged.indexBytesDone += size;
+        }
+        return staged.vertexBytesDone == upload.vertices.size() && staged.indexBytesDone == upload.indices.size();
+    }
+}
+
+void streamMesh(const std::string& path, const ObjLoadOptions& options, Mesh* target, std::function<void(Mesh&)> onReady) {
+    MeshStreamer& s = streamer();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (s.workers.empty()) {
+        for (unsigned i = 0; i < MESH_STREAMING_THREADS; i++) s.workers.emplace_back(&MeshStreamer::work, &s);
+    }
+    s.requests.push_back({ path, options, target, std::move(onReady), std::chrono::steady_clock::now() });
+    s.pending++;
+    s.wake.notify_one();
+}
+
+size_t uploadStreamedMeshes(double budgetMs) {
+    MeshStreamer& s = streamer();
+    if (s.pending == 0) return 0;
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [&] { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(); };
+
+    size_t finished = 0;
+    bool progressed = false;
+    for (;;) {
+        if (!s.uploading) {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (s.ready.empty()) break;
+            s.uploading = std::move(s.ready.front());
+            s.ready.pop_front();
+        }
+        StagedMesh& staged = *s.uploading;
+
+        if (!staged.ok) {
+            std::cerr << "Could not stream mesh: " << staged.request.path << std::endl;
+            s.uploading.reset();
+            s.pending--;
+            continue;
+        }
+
+        // Cel putin o bucata per apel, ca un buget foarte mic sa nu blocheze incarcarea
+        if (progressed && elapsedMs() >= budgetMs) break;
+        progressed = true;
+
+        if (!staged.created) {
+            const MeshUpload& upload = staged.upload;
+            staged.mesh = uploadMeshBuffers(nullptr, upload.vertices.size(), nullptr, upload.indexCount,
+                upload.indexType, upload.layout);
+            staged.created = true;
+            if (!staged.mesh.vao) {
+                std::cerr << "Could not stream mesh: " << staged.request.path << std::endl;
+                s.uploading.reset();
+                s.pending--;
+                continue;
+            }
+        }
+        if (!uploadSlice(staged)) continue;
+
+        copyMeshInfo(staged.upload, staged.mesh);
+        *staged.request.target = std::move(staged.mesh);
+        if (staged.request.onReady) staged.request.onReady(*staged.request.target);
+
+        double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - staged.request.requested).count();
+        std::cout << "Streamed mesh ready: " << staged.request.path << " (" << totalMs << " ms after request)" << std::endl;
+
+        s.uploading.reset();
+        s.pending--;
+        finished++;
+    }
+    return finished;
+}
+
+size_t pendingStreamedMeshes() {
+    return streamer().pending;
+}
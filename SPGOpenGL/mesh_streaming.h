@@ -0,0 +1,24 @@
+#pragma once
+
+#include "obj_loader.hpp"
+#include <functional>
+#include <string>
+
+// Incarcare de modele in fundal, in doua etape:
+//  1. thread-urile de incarcare ruleaza prepareOBJ (cache, parsare, LOD-uri, optimizare) -> MeshUpload;
+//  2. thread-ul GL urca bufferele din uploadStreamedMeshes(), pe bucati, cu un buget de timp per cadru.
+// Pana la terminare Mesh-ul tinta ramane gol (fara LOD-uri), deci nu e desenat.
+
+const unsigned MESH_STREAMING_THREADS = 2;
+// Cat se trimite cu un singur glBufferSubData; bugetul e verificat intre bucati
+const size_t MESH_UPLOAD_SLICE_BYTES = 256 * 1024;
+
+// target trebuie sa traiasca pana la terminare. onReady e apelat pe thread-ul GL, dupa ce *target e complet.
+void streamMesh(const std::string& path, const ObjLoadOptions& options, Mesh* target,
+    std::function<void(Mesh&)> onReady = nullptr);
+
+// Apelat din display(): urca date pana la budgetMs milisecunde. Returneaza cate mesh-uri au fost finalizate.
+size_t uploadStreamedMeshes(double budgetMs);
+
+// Mesh-uri inca in parsare sau in curs de urcare
+size_t pendingStreamedMeshes();
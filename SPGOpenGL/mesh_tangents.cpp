@@ -0,0 +1,114 @@
+#include "mesh_tangents.h"
+#include "vertex_format.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    glm::vec3 readVec3(const std::vector<float>& vertexData, GLuint v, size_t offset) {
+        const float* p = vertexData.data() + (size_t)v * VERTEX_FLOATS + offset;
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+
+    // Orice directie perpendiculara pe n, pentru vertecsii fara UV-uri utilizabile
+    glm::vec3 anyTangent(const glm::vec3& n) {
+        glm::vec3 axis = std::abs(n.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        return glm::normalize(glm::cross(axis, n));
+    }
+
+    // Tangenta acumulata pentru o orientare (w = +1 sau -1) a unui vertex
+    struct TangentSum {
+        glm::vec3 tangent = glm::vec3(0.0f);
+        float weight = 0.0f;
+    };
+}
+
+size_t generateTangents(std::vector<float>& vertexData, std::vector<GLuint>& indices) {
+    size_t vertexCount = vertexData.size() / VERTEX_FLOATS;
+    size_t triangleCount = indices.size() / 3;
+
+    std::vector<TangentSum> positive(vertexCount), negative(vertexCount);
+    // Orientarea fiecarui colt: +1 / -1, 0 = triunghi cu UV-uri degenerate (nu contribuie)
+    std::vector<signed char> cornerSign(indices.size(), 0);
+
+    for (size_t t = 0; t < triangleCount; t++) {
+        const GLuint* tri = &indices[t * 3];
+        glm::vec3 p[3];
+        glm::vec2 uv[3];
+        for (int k = 0; k < 3; k++) {
+            p[k] = readVec3(vertexData, tri[k], 0);
+            const float* tex = vertexData.data() + (size_t)tri[k] * VERTEX_FLOATS + 6;
+            uv[k] = glm::vec2(tex[0], tex[1]);
+        }
+
+        glm::vec3 d1 = p[1] - p[0], d2 = p[2] - p[0];
+        glm::vec2 t1 = uv[1] - uv[0], t2 = uv[2] - uv[0];
+        float area = t1.x * t2.y - t1.y * t2.x;
+        if (area == 0.0f) continue;
+
+        // Derivatele pozitiei dupa u si v (fara impartirea la arie, doar directia conteaza)
+        glm::vec3 dPdu = (t2.y * d1 - t1.y * d2) * (area > 0.0f ? 1.0f : -1.0f);
+        glm::vec3 dPdv = (t1.x * d2 - t2.x * d1) * (area > 0.0f ? 1.0f : -1.0f);
+
+        for (int k = 0; k < 3; k++) {
+            glm::vec3 n = readVec3(vertexData, tri[k], 3);
+            glm::vec3 tangent = dPdu - n * glm::dot(n, dPdu);
+            float length = glm::length(tangent);
+            if (length <= 0.0f) continue;
+            tangent /= length;
+
+            // Ponderare cu unghiul triunghiului in coltul respectiv, ca in MikkTSpace
+            glm::vec3 e1 = p[(k + 1) % 3] - p[k], e2 = p[(k + 2) % 3] - p[k];
+            float l1 = glm::length(e1), l2 = glm::length(e2);
+            if (l1 <= 0.0f || l2 <= 0.0f) continue;
+            float angle = std::acos(glm::clamp(glm::dot(e1, e2) / (l1 * l2), -1.0f, 1.0f));
+
+            signed char sign = glm::dot(glm::cross(n, tangent), dPdv) < 0.0f ? -1 : 1;
+            cornerSign[t * 3 + k] = sign;
+            TangentSum& sum = sign > 0 ? positive[tri[k]] : negative[tri[k]];
+            sum.tangent += tangent * angle;
+            sum.weight += angle;
+        }
+    }
+
+    // Orientarea majoritara ramane pe vertexul original; cealalta primeste o copie
+    std::vector<GLuint> mirrored(vertexCount, 0);
+    size_t added = 0;
+    for (size_t v = 0; v < vertexCount; v++) {
+        if (positive[v].weight > 0.0f && negative[v].weight > 0.0f) {
+            mirrored[v] = (GLuint)(vertexCount + added++);
+        }
+    }
+    vertexData.resize((vertexCount + added) * VERTEX_FLOATS);
+
+    auto writeTangent = [&](size_t v, const TangentSum& sum, float w) {
+        float* out = vertexData.data() + v * VERTEX_FLOATS;
+        glm::vec3 n(out[3], out[4], out[5]);
+        glm::vec3 tangent = sum.tangent - n * glm::dot(n, sum.tangent);
+        float length = glm::length(tangent);
+        tangent = length > 1e-6f ? tangent / length : anyTangent(glm::length(n) > 0.0f ? glm::normalize(n) : glm::vec3(0.0f, 1.0f, 0.0f));
+        out[8] = tangent.x;
+        out[9] = tangent.y;
+        out[10] = tangent.z;
+        out[11] = w;
+    };
+
+    for (size_t v = 0; v < vertexCount; v++) {
+        bool positiveMajority = positive[v].weight >= negative[v].weight;
+        writeTangent(v, positiveMajority ? positive[v] : negative[v], positiveMajority ? 1.0f : -1.0f);
+        if (mirrored[v] == 0) continue;
+
+        std::copy_n(vertexData.begin() + v * VERTEX_FLOATS, 8, vertexData.begin() + (size_t)mirrored[v] * VERTEX_FLOATS);
+        writeTangent(mirrored[v], positiveMajority ? negative[v] : positive[v], positiveMajority ? -1.0f : 1.0f);
+    }
+
+    if (added > 0) {
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            GLuint v = indices[i];
+            if (mirrored[v] == 0 || cornerSign[i] == 0) continue;
+            bool positiveMajority = positive[v].weight >= negative[v].weight;
+            if ((cornerSign[i] > 0) != positiveMajority) indices[i] = mirrored[v];
+        }
+    }
+    return added;
+}
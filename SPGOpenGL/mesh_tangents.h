@@ -0,0 +1,14 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+
+// Tangente per vertex calculate la incarcare, in loc de reconstructia din vertex shader.
+// Rezultatul e compatibil cu MikkTSpace: tangenta e proiectata pe planul normalei vertexului,
+// iar w = +-1 e orientarea, cu bitangenta = w * cross(normala, tangenta).
+
+// vertexData: VERTEX_FLOATS per vertex (vezi vertex_format.h); se completeaza float-urile 8..11.
+// Un vertex folosit de triunghiuri cu orientari UV opuse (UV-uri oglindite) se dubleaza,
+// iar indicii triunghiurilor minoritare sunt mutati pe copie. Returneaza cati vertecsi s-au adaugat.
+size_t generateTangents(std::vector<float>& vertexData, std::vector<GLuint>& indices);
@@ -0,0 +1,207 @@
+#include "meshlet.h"
+#include "frustum_culling.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+    glm::vec3 vertexPosition(const MeshData& data, GLuint v) {
+        const float* p = data.vertexData.data() + (size_t)v * MESH_VERTEX_FLOATS;
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+
+    // Sfera (centrul AABB-ului) si conul normalelor pentru triunghiurile [begin, end) din data.indices
+    Meshlet computeMeshletBounds(const MeshData& data, size_t begin, size_t end) {
+        Meshlet meshlet = {};
+        meshlet.indexOffset = (GLuint)begin;
+        meshlet.indexCount = (GLuint)(end - begin);
+
+        glm::vec3 lo = vertexPosition(data, data.indices[begin]), hi = lo;
+        for (size_t i = begin; i < end; i++) {
+            glm::vec3 p = vertexPosition(data, data.indices[i]);
+            lo = glm::min(lo, p);
+            hi = glm::max(hi, p);
+        }
+        meshlet.center = (lo + hi) * 0.5f;
+        for (size_t i = begin; i < end; i++) {
+            meshlet.radius = std::max(meshlet.radius, glm::length(vertexPosition(data, data.indices[i]) - meshlet.center));
+        }
+
+        glm::vec3 axis(0.0f);
+        for (size_t i = begin; i + 2 < end; i += 3) {
+            glm::vec3 a = vertexPosition(data, data.indices[i]);
+            glm::vec3 n = glm::cross(vertexPosition(data, data.indices[i + 1]) - a, vertexPosition(data, data.indices[i + 2]) - a);
+            float length = glm::length(n);
+            if (length > 0.0f) axis += n / length;
+        }
+        float axisLength = glm::length(axis);
+
+        // coneCutoff = sinusul deschiderii conului; 1 = conul nu poate elimina nimic
+        meshlet.coneAxis = axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+        meshlet.coneCutoff = 1.0f;
+        if (axisLength > 0.0f) {
+            float minDot = 1.0f;
+            for (size_t i = begin; i + 2 < end; i += 3) {
+                glm::vec3 a = vertexPosition(data, data.indices[i]);
+                glm::vec3 n = glm::cross(vertexPosition(data, data.indices[i + 1]) - a, vertexPosition(data, data.indices[i + 2]) - a);
+                float length = glm::length(n);
+                if (length > 0.0f) minDot = std::min(minDot, glm::dot(n / length, meshlet.coneAxis));
+            }
+            if (minDot > 0.0f) meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+        }
+        return meshlet;
+    }
+}
+
+MeshletCuller::MeshletCuller(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, bool coneCulling)
+    : model(model), coneCulling(coneCulling) {
+    frustum = extractFrustum(projection * view);
+
+    cameraPos = glm::vec3(glm::inverse(view)[3]);
+    normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+    scale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+}
+
+bool MeshletCuller::sphereVisible(const BoundingSphere& sphere) const {
+    glm::vec3 center = glm::vec3(model * glm::vec4(sphere.center, 1.0f));
+    float radius = sphere.radius * scale;
+    for (const glm::vec4& plane : frustum.planes) {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+    }
+    return true;
+}
+
+void MeshletCuller::cull(const Mesh& mesh, const SubMesh& submesh, MeshletDrawList& out) const {
+    // Tot submesh-ul in afara frustumului: nu mai testam meshlet-urile
+    if (!sphereVisible(submesh.bounds.sphere)) {
+        out.totalMeshlets += submesh.meshletCount;
+        return;
+    }
+
+    // Fara meshlet-uri: tot submesh-ul
+    if (submesh.meshletCount == 0) {
+        if (submesh.indexCount == 0) return;
+        out.counts.push_back((GLsizei)submesh.indexCount);
+        out.offsets.push_back(mesh.indexOffset(submesh.indexOffset));
+        out.baseVertices.push_back(mesh.baseVertex);
+        return;
+    }
+
+    GLuint lastEnd = ~0u;
+    for (GLuint m = submesh.firstMeshlet; m < submesh.firstMeshlet + submesh.meshletCount; m++) {
+        const Meshlet& meshlet = mesh.meshlets[m];
+        out.totalMeshlets++;
+
+        if (!sphereVisible({ meshlet.center, meshlet.radius })) continue;
+        glm::vec3 center = glm::vec3(model * glm::vec4(meshlet.center, 1.0f));
+        float radius = meshlet.radius * scale;
+
+        if (coneCulling && meshlet.coneCutoff < 1.0f) {
+            glm::vec3 axis = glm::normalize(normalMatrix * meshlet.coneAxis);
+            glm::vec3 toCenter = center - cameraPos;
+            if (glm::dot(toCenter, axis) >= meshlet.coneCutoff * glm::length(toCenter) + radius) continue;
+        }
+
+        out.visibleMeshlets++;
+        if (meshlet.indexOffset == lastEnd) {
+            out.counts.back() += (GLsizei)meshlet.indexCount;
+        }
+        else {
+            out.counts.push_back((GLsizei)meshlet.indexCount);
+            out.offsets.push_back(mesh.indexOffset(meshlet.indexOffset));
+            out.baseVertices.push_back(mesh.baseVertex);
+        }
+        lastEnd = meshlet.indexOffset + meshlet.indexCount;
+    }
+}
+
+void MeshletDrawList::clear() {
+    counts.clear();
+    offsets.clear();
+    baseVertices.clear();
+    visibleMeshlets = 0;
+    totalMeshlets = 0;
+}
+
+void buildMeshlets(MeshData& data, const std::string& name) {
+    size_t vertexCount = data.vertexData.size() / MESH_VERTEX_FLOATS;
+    data.meshlets.clear();
+    if (data.indices.empty() || vertexCount == 0) return;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // stamp[v] == current daca vertexul e deja in meshlet-ul curent
+    std::vector<GLuint> stamp(vertexCount, 0);
+    GLuint current = 0;
+
+    for (SubMesh& submesh : data.submeshes) {
+        submesh.firstMeshlet = (GLuint)data.meshlets.size();
+
+        size_t end = (size_t)submesh.indexOffset + submesh.indexCount;
+        size_t begin = submesh.indexOffset;
+        size_t vertices = 0, triangles = 0;
+        current++;
+
+        // Vertecsii triunghiului i care nu sunt inca in meshlet-ul curent
+        auto newVertices = [&](size_t i) {
+            const GLuint* tri = &data.indices[i];
+            size_t added = 0;
+            for (int k = 0; k < 3; k++) {
+                if (stamp[tri[k]] != current && (k == 0 || tri[k] != tri[0]) && (k < 2 || tri[2] != tri[1])) added++;
+            }
+            return added;
+        };
+
+        // Triunghiurile se iau in ordinea existenta (optimizata pentru cache) pana se umple meshlet-ul
+        for (size_t i = submesh.indexOffset; i + 2 < end; i += 3) {
+            size_t added = newVertices(i);
+            if (vertices + added > MESHLET_MAX_VERTICES || triangles + 1 > MESHLET_MAX_TRIANGLES) {
+                data.meshlets.push_back(computeMeshletBounds(data, begin, i));
+                begin = i;
+                vertices = triangles = 0;
+                current++;
+                added = newVertices(i);
+            }
+
+            for (int k = 0; k < 3; k++) stamp[data.indices[i + k]] = current;
+            vertices += added;
+            triangles++;
+        }
+        if (triangles > 0) data.meshlets.push_back(computeMeshletBounds(data, begin, begin + triangles * 3));
+
+        submesh.meshletCount = (GLuint)data.meshlets.size() - submesh.firstMeshlet;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Built " << data.meshlets.size() << " meshlets for " << name << " in " << ms << " ms" << std::endl;
+}
+
+void cullMeshLod(const Mesh& mesh, int lod, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection,
+    MeshletDrawList& out, bool coneCulling) {
+    out.clear();
+    if (mesh.lods.empty()) return;
+    const MeshLod& level = mesh.lods[std::min(std::max(lod, 0), (int)mesh.lods.size() - 1)];
+
+    MeshletCuller culler(model, view, projection, coneCulling);
+    for (GLuint s = level.firstSubmesh; s < level.firstSubmesh + level.submeshCount; s++) {
+        culler.cull(mesh, mesh.submeshes[s], out);
+    }
+}
+
+void cullSubMesh(const Mesh& mesh, GLuint submesh, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection,
+    MeshletDrawList& out, bool coneCulling) {
+    cullSubMesh(MeshletCuller(model, view, projection, coneCulling), mesh, submesh, out);
+}
+
+void cullSubMesh(const MeshletCuller& culler, const Mesh& mesh, GLuint submesh, MeshletDrawList& out) {
+    if (submesh >= mesh.submeshes.size()) return;
+    culler.cull(mesh, mesh.submeshes[submesh], out);
+}
+
+void drawMeshlets(const Mesh& mesh, const MeshletDrawList& drawList) {
+    if (drawList.counts.empty()) return;
+    // glew declara parametrii fara const
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, const_cast<GLsizei*>(drawList.counts.data()), mesh.indexType,
+        const_cast<void**>(drawList.offsets.data()), (GLsizei)drawList.counts.size(), const_cast<GLint*>(drawList.baseVertices.data()));
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "obj_loader.hpp"
+#include "frustum_culling.h"
+#include <string>
+
+// Meshlet-uri: grupuri mici de triunghiuri consecutive din EBO, cu volume de incadrare
+// pentru culling pe CPU. Se construiesc dupa optimizeMesh, deci pastreaza ordinea pentru cache.
+
+const size_t MESHLET_MAX_VERTICES = 64;
+const size_t MESHLET_MAX_TRIANGLES = 124;
+
+// Imparte fiecare submesh (inclusiv nivelurile LOD) in meshlet-uri si completeaza
+// SubMesh::firstMeshlet / meshletCount.
+void buildMeshlets(MeshData& data, const std::string& name);
+
+// Intervalele de indici ramase dupa culling, gata pentru glMultiDrawElements.
+// Meshlet-urile vizibile consecutive sunt unite intr-un singur interval.
+struct MeshletDrawList {
+    std::vector<GLsizei> counts;
+    std::vector<const void*> offsets;
+    std::vector<GLint> baseVertices; // Mesh::baseVertex pentru fiecare interval
+    size_t visibleMeshlets = 0;
+    size_t totalMeshlets = 0;
+
+    void clear();
+};
+
+// Culling pe frustum (sfera submesh-ului, apoi a fiecarui meshlet) pentru submesh-urile unui LOD.
+// coneCulling elimina si meshlet-urile vazute complet din spate (conul normalelor). Are sens doar cand GL_CULL_FACE
+// e activ si geometria e inchisa; altfel fetele din spate ale modelelor deschise sau cu doua fete sunt vizibile.
+void cullMeshLod(const Mesh& mesh, int lod, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection,
+    MeshletDrawList& out, bool coneCulling = false);
+
+// Planurile frustumului si camera in spatiul lumii, calculate o data pentru un obiect
+// si refolosite pentru toate submesh-urile lui
+struct MeshletCuller {
+    Frustum frustum;
+    glm::vec3 cameraPos;
+    glm::mat4 model;
+    glm::mat3 normalMatrix;
+    float scale;
+    bool coneCulling;
+
+    MeshletCuller(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, bool coneCulling = false);
+
+    bool sphereVisible(const BoundingSphere& sphere) const;
+    // Adauga la out intervalele vizibile ale submesh-ului
+    void cull(const Mesh& mesh, const SubMesh& submesh, MeshletDrawList& out) const;
+};
+
+// La fel pentru un singur submesh (de ex. un material); adauga la out fara sa-l goleasca
+void cullSubMesh(const Mesh& mesh, GLuint submesh, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection,
+    MeshletDrawList& out, bool coneCulling = false);
+// Cu un culler construit o data pentru obiect
+void cullSubMesh(const MeshletCuller& culler, const Mesh& mesh, GLuint submesh, MeshletDrawList& out);
+
+// Deseneaza o lista produsa de cullMeshLod; VAO-ul arenei trebuie sa fie deja legat (bindGeometryArena)
+void drawMeshlets(const Mesh& mesh, const MeshletDrawList& drawList);
@@ -1,9 +1,21 @@
 #include "obj_loader.hpp"
+#include "mapped_file.h"
+#include "mesh_cache.h"
+#include "mesh_optimizer.h"
+#include "mesh_lod.h"
+#include "meshlet.h"
+#include "mesh_tangents.h"
+#include "geometry_arena.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <algorithm>
 #include <map>
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <thread>
 
 struct VertexKey {
     int pos, tex, norm;
@@ -12,134 +24,751 @@ struct VertexKey {
         if (tex != other.tex) return tex < other.tex;
         return norm < other.norm;
     }
+    bool operator==(const VertexKey& other) const {
+        return pos == other.pos && tex == other.tex && norm == other.norm;
+    }
 };
 
-Mesh loadOBJ(const std::string& path) {
-    std::vector<glm::vec3> positions;
-    std::vector<glm::vec2> texCoords;
-    std::vector<glm::vec3> normals;
-    std::vector<GLuint> indices;
-    std::vector<float> vertexData;
+namespace {
+    // Tokenizare direct in bufferul mapat, fara alocari per linie.
+    inline bool isBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
 
+    inline const char* skipBlanks(const char* p, const char* end) {
+        while (p < end && isBlank(*p)) ++p;
+        return p;
+    }
 
-    std::map<VertexKey, GLuint> vertexMap;
-    GLuint vertexCount = 0;
+    inline const char* skipLine(const char* p, const char* end) {
+        const void* nl = memchr(p, '\n', end - p);
+        return nl ? (const char*)nl + 1 : end;
+    }
 
-    std::ifstream file(path);
-    if (!file) {
-        std::cerr << "Eroare la deschiderea modelului: " << path << std::endl;
-        return {};
+    inline bool atTokenEnd(const char* p, const char* end) {
+        return p >= end || isBlank(*p) || *p == '\n' || *p == '#';
     }
 
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
+    // std::from_chars nu accepta '+' in fata numarului
+    inline const char* parseFloat(const char* p, const char* end, float& value) {
+        p = skipBlanks(p, end);
+        if (p < end && *p == '+') ++p;
+        auto res = std::from_chars(p, end, value);
+        if (res.ec != std::errc()) {
+            value = 0.0f;
+            return p;
+        }
+        return res.ptr;
+    }
 
-        std::stringstream ss(line);
-        std::string type;
-        ss >> type;
+    inline const char* parseIndex(const char* p, const char* end, int& value) {
+        value = 0;
+        if (p < end && *p == '+') ++p;
+        auto res = std::from_chars(p, end, value);
+        return res.ec == std::errc() ? res.ptr : p;
+    }
 
-        if (type == "v") {
-            glm::vec3 v;
-            ss >> v.x >> v.y >> v.z;
-            positions.push_back(v);
+    // Tabela de dispersie cu adresare deschisa (sondare liniara) pentru deduplicarea v/vt/vn.
+    // Capacitatea se fixeaza o singura data din numarul de colturi numarate in avans,
+    // deci nu mai exista alocari per vertex si nici rehash.
+    class VertexHashMap {
+    public:
+        void reserve(size_t maxKeys) {
+            size_t capacity = 16;
+            while (capacity < maxKeys * 2) capacity <<= 1;
+            slots.assign(capacity, Slot{});
+            mask = capacity - 1;
+            count = 0;
         }
-        else if (type == "vt") {
-            glm::vec2 uv;
-            ss >> uv.x >> uv.y;
-            texCoords.push_back(uv);
+
+        // Intoarce indexul existent sau insereaza newIndex; inserted spune care caz a fost.
+        GLuint findOrInsert(const VertexKey& key, GLuint newIndex, bool& inserted) {
+            if (count * 2 >= slots.size()) grow();
+
+            size_t i = hash(key) & mask;
+            for (;;) {
+                Slot& slot = slots[i];
+                if (slot.key.pos == 0) {
+                    slot.key = key;
+                    slot.index = newIndex;
+                    count++;
+                    inserted = true;
+                    return newIndex;
+                }
+                if (slot.key == key) {
+                    inserted = false;
+                    return slot.index;
+                }
+                i = (i + 1) & mask;
+            }
         }
-        else if (type == "vn") {
-            glm::vec3 n;
-            ss >> n.x >> n.y >> n.z;
-            normals.push_back(glm::normalize(n));
+
+    private:
+        // pos == 0 marcheaza un slot liber (indicii OBJ valizi incep de la 1)
+        struct Slot {
+            VertexKey key = { 0, 0, 0 };
+            GLuint index = 0;
+        };
+
+        std::vector<Slot> slots;
+        size_t mask = 0;
+        size_t count = 0;
+
+        static size_t hash(const VertexKey& key) {
+            uint64_t h = (uint32_t)key.pos * 0x9E3779B97F4A7C15ull;
+            h ^= (uint32_t)key.tex * 0xC2B2AE3D27D4EB4Full;
+            h ^= (uint32_t)key.norm * 0x165667B19E3779F9ull;
+            return (size_t)(h ^ (h >> 29));
         }
-        else if (type == "f") {
-            std::vector<std::string> faceVertices;
-            std::string vertex;
-            while (ss >> vertex) {
-                faceVertices.push_back(vertex);
+
+        // Doar daca numaratoarea initiala a fost depasita
+        void grow() {
+            std::vector<Slot> old;
+            old.swap(slots);
+            reserve(old.size());
+            for (const Slot& slot : old) {
+                if (slot.key.pos == 0) continue;
+                bool inserted;
+                findOrInsert(slot.key, slot.index, inserted);
             }
+        }
+    };
 
-           
-            std::vector<int> triangleIndices;
-            if (faceVertices.size() == 3) {
-                triangleIndices = { 0, 1, 2 };
+    enum class ObjRecord { Position, TexCoord, Normal, Face, UseMaterial, MaterialLibrary, Other };
+
+    // Citeste cuvantul cheie de la inceputul liniei; numararea si parsarea folosesc
+    // exact aceeasi clasificare, altfel offset-urile calculate nu s-ar potrivi.
+    inline ObjRecord readKeyword(const char*& p, const char* end) {
+        p = skipBlanks(p, end);
+        const char* keyword = p;
+        while (!atTokenEnd(p, end)) ++p;
+        size_t length = p - keyword;
+
+        if (length == 1 && keyword[0] == 'v') return ObjRecord::Position;
+        if (length == 2 && keyword[0] == 'v' && keyword[1] == 't') return ObjRecord::TexCoord;
+        if (length == 2 && keyword[0] == 'v' && keyword[1] == 'n') return ObjRecord::Normal;
+        if (length == 1 && keyword[0] == 'f') return ObjRecord::Face;
+        if (length == 6 && memcmp(keyword, "usemtl", 6) == 0) return ObjRecord::UseMaterial;
+        if (length == 6 && memcmp(keyword, "mtllib", 6) == 0) return ObjRecord::MaterialLibrary;
+        return ObjRecord::Other;
+    }
+
+    inline bool atLineEnd(const char* p, const char* end) {
+        return p >= end || *p == '\n' || *p == '#';
+    }
+
+    // Restul liniei fara spatiile de la capete (nume de material / fisier)
+    std::string readName(const char* p, const char* end) {
+        p = skipBlanks(p, end);
+        const char* nameEnd = p;
+        while (!atLineEnd(nameEnd, end)) ++nameEnd;
+        while (nameEnd > p && isBlank(nameEnd[-1])) --nameEnd;
+        return std::string(p, nameEnd);
+    }
+
+    struct ObjCounts {
+        size_t positions = 0, texCoords = 0, normals = 0;
+        size_t faceCorners = 0;     // colturi scrise in fisier (limita superioara pentru vertecsi unici)
+        size_t triangleCorners = 0; // indici emisi dupa triangulare
+    };
+
+    // Trecere rapida peste fisier, doar pentru dimensionarea bufferelor.
+    ObjCounts countRecords(const char* p, const char* end) {
+        ObjCounts counts;
+        while (p < end) {
+            switch (readKeyword(p, end)) {
+            case ObjRecord::Position: counts.positions++; break;
+            case ObjRecord::TexCoord: counts.texCoords++; break;
+            case ObjRecord::Normal: counts.normals++; break;
+            case ObjRecord::Face: {
+                size_t corners = 0;
+                for (;;) {
+                    p = skipBlanks(p, end);
+                    if (atLineEnd(p, end)) break;
+                    while (!atTokenEnd(p, end)) ++p;
+                    corners++;
+                }
+                counts.faceCorners += corners;
+                if (corners >= 3) counts.triangleCorners += (corners - 2) * 3;
+                break;
             }
-            else if (faceVertices.size() == 4) {
-                triangleIndices = { 0, 1, 2, 0, 2, 3 }; 
+            default: break;
             }
+            p = skipLine(p, end);
+        }
+        return counts;
+    }
+
+    // Colt de triunghi dupa rezolvarea indicilor relativi.
+    // key.pos == 0 inseamna colt invalid (ignorat, ca in vechiul loader).
+    struct FaceCorner {
+        VertexKey key;
+        bool hasTex, hasNorm;
+    };
+
+    struct ObjRecords {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec2> texCoords;
+        std::vector<glm::vec3> normals;
+        std::vector<FaceCorner> corners;
+    };
 
-            for (int idx : triangleIndices) {
-                std::string face = faceVertices[idx];
-                std::replace(face.begin(), face.end(), '/', ' ');
-                std::stringstream fss(face);
+    // usemtl: materialul se aplica triunghiurilor incepand cu triangle (index global)
+    struct MaterialSwitch {
+        size_t triangle;
+        std::string name;
+    };
 
-                int vi = 0, ti = 0, ni = 0;
-                fss >> vi;
-                if (fss.peek() != EOF) fss >> ti;
-                if (fss.peek() != EOF) fss >> ni;
+    // Bucata din fisier aliniata la linii; base = cate inregistrari au fost inaintea ei.
+    struct ObjChunk {
+        const char* begin;
+        const char* end;
+        ObjCounts counts;
+        ObjCounts base;
+        std::vector<MaterialSwitch> materialSwitches;
+        std::string materialLibrary;
+    };
+
+    // Un colt de fata: v, v/vt, v//vn sau v/vt/vn.
+    const char* parseCorner(const char* p, const char* end, VertexKey& key) {
+        key = { 0, 0, 0 };
+        p = parseIndex(p, end, key.pos);
+        if (p < end && *p == '/') {
+            ++p;
+            if (p < end && *p != '/') p = parseIndex(p, end, key.tex);
+            if (p < end && *p == '/') {
+                ++p;
+                p = parseIndex(p, end, key.norm);
+            }
+        }
+        while (!atTokenEnd(p, end)) ++p;
+        return p;
+    }
 
-                if (vi > 0 && vi <= positions.size()) {
-                    VertexKey key = { vi, ti, ni };
+    // Scrie inregistrarile bucatii direct la offset-urile ei globale. Validitatea si
+    // indicii negativi se rezolva fata de cate v/vt/vn apar inainte de fata in tot
+    // fisierul, deci rezultatul nu depinde de felul in care a fost impartit fisierul.
+    void parseChunk(ObjChunk& chunk, ObjRecords& records) {
+        glm::vec3* positions = records.positions.data() + chunk.base.positions;
+        glm::vec2* texCoords = records.texCoords.data() + chunk.base.texCoords;
+        glm::vec3* normals = records.normals.data() + chunk.base.normals;
+        FaceCorner* corners = records.corners.data() + chunk.base.triangleCorners;
+        size_t positionCount = 0, texCoordCount = 0, normalCount = 0;
 
-                    auto it = vertexMap.find(key);
-                    if (it != vertexMap.end()) {
-                       
-                        indices.push_back(it->second);
+        std::vector<FaceCorner> face; // refolosit de la o fata la alta
+
+        const char* p = chunk.begin;
+        const char* end = chunk.end;
+        while (p < end) {
+            switch (readKeyword(p, end)) {
+            case ObjRecord::Position: {
+                glm::vec3& v = positions[positionCount++];
+                p = parseFloat(p, end, v.x);
+                p = parseFloat(p, end, v.y);
+                p = parseFloat(p, end, v.z);
+                break;
+            }
+            case ObjRecord::TexCoord: {
+                glm::vec2& uv = texCoords[texCoordCount++];
+                p = parseFloat(p, end, uv.x);
+                p = parseFloat(p, end, uv.y);
+                break;
+            }
+            case ObjRecord::Normal: {
+                glm::vec3 n;
+                p = parseFloat(p, end, n.x);
+                p = parseFloat(p, end, n.y);
+                p = parseFloat(p, end, n.z);
+                normals[normalCount++] = glm::normalize(n);
+                break;
+            }
+            case ObjRecord::Face: {
+                int totalPositions = (int)(chunk.base.positions + positionCount);
+                int totalTexCoords = (int)(chunk.base.texCoords + texCoordCount);
+                int totalNormals = (int)(chunk.base.normals + normalCount);
+
+                face.clear();
+                for (;;) {
+                    p = skipBlanks(p, end);
+                    if (atLineEnd(p, end)) break;
+
+                    FaceCorner corner;
+                    VertexKey& key = corner.key;
+                    p = parseCorner(p, end, key);
+                    if (key.pos < 0) key.pos += totalPositions + 1;
+                    if (key.tex < 0) key.tex += totalTexCoords + 1;
+                    if (key.norm < 0) key.norm += totalNormals + 1;
+
+                    if (key.pos <= 0 || key.pos > totalPositions) key.pos = 0;
+                    corner.hasTex = key.tex > 0 && key.tex <= totalTexCoords;
+                    corner.hasNorm = key.norm > 0 && key.norm <= totalNormals;
+                    face.push_back(corner);
+                }
+
+                // Triangulare in evantai (pentru quad-uri: 0 1 2, 0 2 3).
+                // Un triunghi cu un colt invalid se renunta in intregime.
+                for (size_t i = 1; i + 1 < face.size(); i++) {
+                    corners[0] = face[0];
+                    corners[1] = face[i];
+                    corners[2] = face[i + 1];
+                    if (corners[0].key.pos == 0 || corners[1].key.pos == 0 || corners[2].key.pos == 0) {
+                        corners[0].key.pos = corners[1].key.pos = corners[2].key.pos = 0;
                     }
-                    else {
-                       
-                        glm::vec3 pos = positions[vi - 1];
-                        glm::vec2 tex = (ti > 0 && ti <= texCoords.size()) ? texCoords[ti - 1] : glm::vec2(0.0f);
-                        glm::vec3 norm = (ni > 0 && ni <= normals.size()) ? normals[ni - 1] : glm::vec3(0.0f, 1.0f, 0.0f);
-
-                        vertexData.insert(vertexData.end(), {
-                            pos.x, pos.y, pos.z,
-                            norm.x, norm.y, norm.z,
-                            tex.x, tex.y
-                            });
-
-                        vertexMap[key] = vertexCount;
-                        indices.push_back(vertexCount);
-                        vertexCount++;
+                    corners += 3;
+                }
+                break;
+            }
+            case ObjRecord::UseMaterial:
+                chunk.materialSwitches.push_back({ (size_t)(corners - records.corners.data()) / 3, readName(p, end) });
+                break;
+            case ObjRecord::MaterialLibrary:
+                if (chunk.materialLibrary.empty()) chunk.materialLibrary = readName(p, end);
+                break;
+            default: break;
+            }
+            p = skipLine(p, end);
+        }
+    }
+
+    // Deduplicarea ramane secventiala, in ordinea colturilor din fisier,
+    // ca numerotarea vertecsilor sa fie aceeasi indiferent de numarul de thread-uri.
+    // faceMaterials: materialul fiecarui triunghi din records.corners; triangleMaterials primeste
+    // materialul fiecarui triunghi pastrat in out.indices.
+    void buildVertices(const ObjRecords& records, size_t faceCorners, const std::vector<GLuint>& faceMaterials,
+        MeshData& out, std::vector<GLuint>& triangleMaterials) {
+        VertexHashMap vertexMap;
+        vertexMap.reserve(faceCorners);
+        out.indices.reserve(records.corners.size());
+        out.vertexData.reserve(std::max({ records.positions.size(), records.texCoords.size(), records.normals.size() }) * MESH_VERTEX_FLOATS);
+
+        GLuint vertexCount = 0;
+        for (size_t i = 0; i < records.corners.size(); i++) {
+            const FaceCorner& corner = records.corners[i];
+            if (corner.key.pos == 0) continue;
+            if (i % 3 == 0) triangleMaterials.push_back(faceMaterials[i / 3]);
+
+            bool inserted;
+            GLuint index = vertexMap.findOrInsert(corner.key, vertexCount, inserted);
+            out.indices.push_back(index);
+            if (!inserted) continue;
+
+            glm::vec3 pos = records.positions[corner.key.pos - 1];
+            glm::vec2 tex = corner.hasTex ? records.texCoords[corner.key.tex - 1] : glm::vec2(0.0f);
+            glm::vec3 norm = corner.hasNorm ? records.normals[corner.key.norm - 1] : glm::vec3(0.0f, 1.0f, 0.0f);
+
+            out.vertexData.insert(out.vertexData.end(), {
+                pos.x, pos.y, pos.z,
+                norm.x, norm.y, norm.z,
+                tex.x, tex.y,
+                0.0f, 0.0f, 0.0f, 1.0f // tangenta, completata de generateTangents
+                });
+            vertexCount++;
+        }
+    }
+
+    // Indexul materialului cu numele dat; il adauga la prima folosire
+    GLuint materialIndex(MeshData& data, const std::string& name) {
+        for (size_t i = 0; i < data.materialNames.size(); i++) {
+            if (data.materialNames[i] == name) return (GLuint)i;
+        }
+        data.materialNames.push_back(name);
+        return (GLuint)data.materialNames.size() - 1;
+    }
+
+    // Ruleaza fn(0..count-1) pe thread-uri separate; indexul 0 pe thread-ul apelant.
+    template <typename Fn>
+    void runParallel(size_t count, const Fn& fn) {
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < count; i++) workers.emplace_back(fn, i);
+        if (count > 0) fn(0);
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    // Sub ~1 MB pe bucata nu merita pornit un thread
+    const size_t MIN_CHUNK_BYTES = 1 << 20;
+
+    bool parseOBJMapped(const std::string& path, MeshData& out, std::vector<GLuint>& triangleMaterials, size_t& bytes,
+        unsigned& threadsUsed, unsigned threads) {
+        MappedFile file(path);
+        if (!file.isOpen()) return false;
+        bytes = file.size();
+
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        size_t chunkCount = std::min<size_t>(threads, std::max<size_t>(1, bytes / MIN_CHUNK_BYTES));
+        threadsUsed = (unsigned)chunkCount;
+
+        std::vector<ObjChunk> chunks(chunkCount);
+        const char* p = file.begin();
+        for (size_t i = 0; i < chunkCount; i++) {
+            const char* split = (i + 1 == chunkCount) ? file.end() : file.begin() + bytes * (i + 1) / chunkCount;
+            if (split < p) split = p;
+            split = skipLine(split, file.end());
+            if (i + 1 == chunkCount) split = file.end();
+            chunks[i].begin = p;
+            chunks[i].end = split;
+            p = split;
+        }
+
+        runParallel(chunkCount, [&](size_t i) {
+            chunks[i].counts = countRecords(chunks[i].begin, chunks[i].end);
+        });
+
+        ObjCounts total;
+        for (ObjChunk& chunk : chunks) {
+            chunk.base = total;
+            total.positions += chunk.counts.positions;
+            total.texCoords += chunk.counts.texCoords;
+            total.normals += chunk.counts.normals;
+            total.faceCorners += chunk.counts.faceCorners;
+            total.triangleCorners += chunk.counts.triangleCorners;
+        }
+
+        ObjRecords records;
+        records.positions.resize(total.positions);
+        records.texCoords.resize(total.texCoords);
+        records.normals.resize(total.normals);
+        records.corners.resize(total.triangleCorners);
+
+        runParallel(chunkCount, [&](size_t i) {
+            parseChunk(chunks[i], records);
+        });
+
+        // Schimbarile de material din toate bucatile, in ordinea din fisier
+        size_t triangleCount = records.corners.size() / 3;
+        std::vector<GLuint> faceMaterials(triangleCount);
+        size_t triangle = 0;
+        std::string current;
+        for (const ObjChunk& chunk : chunks) {
+            if (out.materialLibrary.empty()) out.materialLibrary = chunk.materialLibrary;
+            for (const MaterialSwitch& change : chunk.materialSwitches) {
+                if (change.triangle > triangle) {
+                    std::fill(faceMaterials.begin() + triangle, faceMaterials.begin() + change.triangle, materialIndex(out, current));
+                }
+                triangle = std::max(triangle, change.triangle);
+                current = change.name;
+            }
+        }
+        if (triangleCount > triangle) {
+            std::fill(faceMaterials.begin() + triangle, faceMaterials.end(), materialIndex(out, current));
+        }
+
+        buildVertices(records, total.faceCorners, faceMaterials, out, triangleMaterials);
+        return true;
+    }
+
+    bool parseOBJStream(const std::string& path, MeshData& out, std::vector<GLuint>& triangleMaterials, size_t& bytes) {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec2> texCoords;
+        std::vector<glm::vec3> normals;
+        std::vector<GLuint>& indices = out.indices;
+        std::vector<float>& vertexData = out.vertexData;
+
+        std::map<VertexKey, GLuint> vertexMap;
+        GLuint vertexCount = 0;
+        std::string material;
+
+        std::ifstream file(path);
+        if (!file) return false;
+
+        std::string line;
+        while (std::getline(file, line)) {
+            bytes += line.size() + 1;
+            if (line.empty()) continue;
+
+            std::stringstream ss(line);
+            std::string type;
+            ss >> type;
+
+            if (type == "v") {
+                glm::vec3 v;
+                ss >> v.x >> v.y >> v.z;
+                positions.push_back(v);
+            }
+            else if (type == "vt") {
+                glm::vec2 uv;
+                ss >> uv.x >> uv.y;
+                texCoords.push_back(uv);
+            }
+            else if (type == "vn") {
+                glm::vec3 n;
+                ss >> n.x >> n.y >> n.z;
+                normals.push_back(glm::normalize(n));
+            }
+            else if (type == "usemtl") {
+                ss >> material;
+            }
+            else if (type == "mtllib") {
+                if (out.materialLibrary.empty()) ss >> out.materialLibrary;
+            }
+            else if (type == "f") {
+                std::vector<std::string> faceVertices;
+                std::string vertex;
+                while (ss >> vertex) {
+                    faceVertices.push_back(vertex);
+                }
+
+                std::vector<int> triangleIndices;
+                if (faceVertices.size() == 3) {
+                    triangleIndices = { 0, 1, 2 };
+                }
+                else if (faceVertices.size() == 4) {
+                    triangleIndices = { 0, 1, 2, 0, 2, 3 };
+                }
+
+                size_t indicesBefore = indices.size();
+                for (int idx : triangleIndices) {
+                    std::string face = faceVertices[idx];
+                    std::replace(face.begin(), face.end(), '/', ' ');
+                    std::stringstream fss(face);
+
+                    int vi = 0, ti = 0, ni = 0;
+                    fss >> vi;
+                    if (fss.peek() != EOF) fss >> ti;
+                    if (fss.peek() != EOF) fss >> ni;
+
+                    if (vi > 0 && vi <= positions.size()) {
+                        VertexKey key = { vi, ti, ni };
+
+                        auto it = vertexMap.find(key);
+                        if (it != vertexMap.end()) {
+                            indices.push_back(it->second);
+                        }
+                        else {
+                            glm::vec3 pos = positions[vi - 1];
+                            glm::vec2 tex = (ti > 0 && ti <= texCoords.size()) ? texCoords[ti - 1] : glm::vec2(0.0f);
+                            glm::vec3 norm = (ni > 0 && ni <= normals.size()) ? normals[ni - 1] : glm::vec3(0.0f, 1.0f, 0.0f);
+
+                            vertexData.insert(vertexData.end(), {
+                                pos.x, pos.y, pos.z,
+                                norm.x, norm.y, norm.z,
+                                tex.x, tex.y,
+                                0.0f, 0.0f, 0.0f, 1.0f
+                                });
+
+                            vertexMap[key] = vertexCount;
+                            indices.push_back(vertexCount);
+                            vertexCount++;
+                        }
                     }
                 }
+                for (size_t i = indicesBefore; i + 2 < indices.size(); i += 3) {
+                    triangleMaterials.push_back(materialIndex(out, material));
+                }
             }
         }
+        return true;
+    }
+
+    // Sortare stabila (counting sort) a triunghiurilor dupa material si cate un submesh per material.
+    // Ordinea triunghiurilor in cadrul unui material ramane cea din fisier.
+    void groupByMaterial(MeshData& data, std::vector<GLuint> triangleMaterials) {
+        triangleMaterials.resize(data.indices.size() / 3, 0);
+        size_t materialCount = std::max<size_t>(1, data.materialNames.size());
+        if (data.materialNames.empty()) data.materialNames.push_back("");
+
+        std::vector<GLuint> starts(materialCount + 1, 0);
+        for (GLuint material : triangleMaterials) starts[material + 1] += 3;
+        for (size_t m = 0; m < materialCount; m++) starts[m + 1] += starts[m];
+
+        if (materialCount > 1) {
+            std::vector<GLuint> sorted(data.indices.size());
+            std::vector<GLuint> next(starts.begin(), starts.end() - 1);
+            for (size_t t = 0; t < triangleMaterials.size(); t++) {
+                GLuint& at = next[triangleMaterials[t]];
+                std::copy_n(data.indices.begin() + t * 3, 3, sorted.begin() + at);
+                at += 3;
+            }
+            data.indices.swap(sorted);
+        }
+
+        for (size_t m = 0; m < materialCount; m++) {
+            if (starts[m + 1] == starts[m] && materialCount > 1) continue;
+            SubMesh submesh;
+            submesh.indexOffset = starts[m];
+            submesh.indexCount = starts[m + 1] - starts[m];
+            submesh.material = (GLuint)m;
+            data.submeshes.push_back(submesh);
+        }
+    }
+}
+
+bool parseOBJ(const std::string& path, MeshData& out, const ObjLoadOptions& options) {
+    out.vertexData.clear();
+    out.indices.clear();
+    out.submeshes.clear();
+    out.lods.clear();
+    out.meshlets.clear();
+    out.materialLibrary.clear();
+    out.materialNames.clear();
+    std::vector<GLuint> triangleMaterials;
+
+    auto start = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+    unsigned threadsUsed = 1;
+    bool ok = options.legacyParser
+        ? parseOBJStream(path, out, triangleMaterials, bytes)
+        : parseOBJMapped(path, out, triangleMaterials, bytes, threadsUsed, options.threads);
+    if (!ok) {
+        std::cerr << "Eroare la deschiderea modelului: " << path << std::endl;
+        return false;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double megabytes = bytes / (1024.0 * 1024.0);
+    std::cout << "Parsed " << path << " (" << (options.legacyParser ? "stream" : "mmap") << ", "
+        << threadsUsed << (threadsUsed == 1 ? " thread): " : " threads): ")
+        << megabytes << " MB in " << seconds * 1000.0 << " ms, "
+        << (seconds > 0.0 ? megabytes / seconds : 0.0) << " MB/s" << std::endl;
+
+    groupByMaterial(out, triangleMaterials);
+    out.lods.push_back({ 0, (GLuint)out.submeshes.size(), 0.0f });
+
+    // Tangentele se calculeaza inainte de LOD-uri si optimizari, care doar refolosesc/reordoneaza vertecsii
+    auto tangentStart = std::chrono::steady_clock::now();
+    size_t mirrored = generateTangents(out.vertexData, out.indices);
+    std::cout << "Generated tangents for " << path << " in "
+        << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tangentStart).count() << " ms ("
+        << mirrored << " vertices split for mirrored UVs)" << std::endl;
+
+    computeMeshBounds(out);
+    return true;
+}
+
+void computeMeshBounds(MeshData& data) {
+    data.bounds = computeBounds(data.vertexData.data(), MESH_VERTEX_FLOATS, data.vertexData.size() / MESH_VERTEX_FLOATS);
+    for (SubMesh& submesh : data.submeshes) {
+        submesh.bounds = computeBounds(data.vertexData.data(), MESH_VERTEX_FLOATS,
+            data.indices.data() + submesh.indexOffset, submesh.indexCount);
     }
+}
+
+MeshUpload packMesh(const MeshData& data, VertexLayout layout) {
+    MeshUpload upload;
+    size_t vertexCount = data.vertexData.size() / MESH_VERTEX_FLOATS;
+    upload.vertices = packVertices(data.vertexData.data(), vertexCount, layout, upload.dequantization);
+    upload.indexType = chooseIndexType(vertexCount);
+    upload.indices = packIndices(data.indices.data(), data.indices.size(), upload.indexType);
+    upload.indexCount = data.indices.size();
+    upload.layout = layout;
+    upload.bounds = data.bounds;
+    upload.submeshes = data.submeshes;
+    upload.lods = data.lods;
+    upload.meshlets = data.meshlets;
+    upload.materialLibrary = data.materialLibrary;
+    for (const std::string& name : data.materialNames) {
+        Material material;
+        material.name = name;
+        upload.materials.push_back(material);
+    }
+    return upload;
+}
+
+Mesh uploadMesh(const MeshData& data, VertexLayout layout) {
+    return uploadMesh(packMesh(data, layout));
+}
 
+Mesh uploadMesh(const MeshUpload& upload) {
+    Mesh mesh = uploadMeshBuffers(upload.vertices.data(), upload.vertices.size(), upload.indices.data(), upload.indexCount,
+        upload.indexType, upload.layout);
+    copyMeshInfo(upload, mesh);
+    return mesh;
+}
+
+void copyMeshInfo(const MeshUpload& upload, Mesh& mesh) {
+    mesh.bounds = upload.bounds;
+    mesh.submeshes = upload.submeshes;
+    mesh.lods = upload.lods;
+    mesh.meshlets = upload.meshlets;
+    mesh.materialLibrary = upload.materialLibrary;
+    mesh.materials = upload.materials;
+    mesh.positionTransform = upload.dequantization.matrix();
+}
+
+Mesh uploadMeshBuffers(const void* vertices, size_t vertexBytes, const void* indices, size_t indexCount,
+    GLenum indexType, VertexLayout layout) {
     Mesh mesh;
-    mesh.indexCount = indices.size();
+    mesh.indexCount = indexCount;
+    mesh.indexType = indexType;
+    mesh.layout = layout;
+
+    size_t indexBytes = indexCount * indexSize(indexType);
+    GeometryRange range;
+    if (!allocateGeometry(layout, vertexBytes / vertexStride(layout), indexBytes, range)) {
+        mesh.vao = 0;
+        mesh.indexCount = 0;
+        return mesh;
+    }
+    mesh.vao = geometryArenaVao();
+    mesh.baseVertex = range.baseVertex;
+    mesh.firstIndexByte = range.firstIndexByte;
+
+    if (vertices) writeGeometryVertices((size_t)range.baseVertex * vertexStride(layout), vertices, vertexBytes);
+    if (indices) writeGeometryIndices(range.firstIndexByte, indices, indexBytes);
+
+    return mesh;
+}
+
+bool prepareOBJ(const std::string& path, const ObjLoadOptions& options, MeshUpload& out) {
+    std::string cachePath = meshCachePath(path);
+    uint32_t cacheFlags = (options.optimize ? MESH_CACHE_OPTIMIZED : 0) |
+        (options.layout == VertexLayout::Compact ? MESH_CACHE_COMPACT : 0) |
+        (options.generateLods ? MESH_CACHE_LODS : 0) |
+        (options.buildMeshlets ? MESH_CACHE_MESHLETS : 0) |
+        (options.legacyParser ? MESH_CACHE_LEGACY_PARSER : 0);
+    uint64_t sourceHash = 0;
+    if (options.useCache) {
+        MappedFile source(path);
+        if (!source.isOpen()) {
+            std::cerr << "Eroare la deschiderea modelului: " << path << std::endl;
+            return false;
+        }
+        sourceHash = hashBytes(source.data(), source.size());
+
+        if (loadMeshCache(cachePath, sourceHash, cacheFlags, out)) {
+            resolveMaterials(path, out.materialLibrary, out.materials);
+            return true;
+        }
+    }
 
-    glGenVertexArrays(1, &mesh.vao);
-    glGenBuffers(1, &mesh.vbo);
-    glGenBuffers(1, &mesh.ebo);
+    MeshData data;
+    if (!parseOBJ(path, data, options)) {
+        return false;
+    }
 
-    glBindVertexArray(mesh.vao);
+    if (options.generateLods) {
+        buildMeshLods(data, path);
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(float), vertexData.data(), GL_STATIC_DRAW);
+    if (options.optimize) {
+        optimizeMesh(data, path);
+    }
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    if (options.buildMeshlets) {
+        buildMeshlets(data, path);
+    }
 
-    // Position
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // Normal
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // TexCoords
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    if (options.layout == VertexLayout::Compact) {
+        reportQuantizationError(path, data.vertexData.data(), data.vertexData.size() / MESH_VERTEX_FLOATS);
+    }
 
-    glBindVertexArray(0);
+    out = packMesh(data, options.layout);
+    if (options.useCache && !writeMeshCache(cachePath, sourceHash, cacheFlags, out)) {
+        std::cerr << "Could not write mesh cache: " << cachePath << std::endl;
+    }
+    resolveMaterials(path, out.materialLibrary, out.materials);
 
     std::cout << "Loaded model: " << path << std::endl;
-    std::cout << "Unique vertices: " << vertexCount << std::endl;
-    std::cout << "Indices: " << indices.size() << std::endl;
-    std::cout << "Triangles: " << indices.size() / 3 << std::endl;
+    std::cout << "Unique vertices: " << data.vertexData.size() / MESH_VERTEX_FLOATS << std::endl;
+    std::cout << "Indices: " << data.indices.size() << std::endl;
+    std::cout << "Triangles: " << data.indices.size() / 3 << std::endl;
+    std::cout << "Materials: " << data.materialNames.size() << std::endl;
+    return true;
+}
 
-    return mesh;
-}
\ No newline at end of file
+Mesh loadOBJ(const std::string& path, const ObjLoadOptions& options) {
+    MeshUpload upload;
+    if (!prepareOBJ(path, options, upload)) {
+        return {};
+    }
+    return uploadMesh(upload);
+}
@@ -3,10 +3,116 @@
 #include <string>
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include "vertex_format.h"
+#include "material.h"
+#include "bounds.h"
+
+// Interval din index buffer desenat cu un singur apel, cu un singur material
+struct SubMesh {
+    GLuint indexOffset;
+    GLuint indexCount;
+    GLuint material = 0;     // index in Mesh::materials / MeshData::materialNames
+    GLuint firstMeshlet = 0; // meshlet-urile care acopera intervalul (vezi meshlet.h)
+    GLuint meshletCount = 0;
+    Bounds bounds;           // doar vertecsii folositi de interval
+};
+
+// Grup de triunghiuri consecutive din EBO, cu volume de incadrare in spatiul modelului
+struct Meshlet {
+    GLuint indexOffset;
+    GLuint indexCount;
+    glm::vec3 center;   // sfera de incadrare
+    float radius;
+    glm::vec3 coneAxis; // conul normalelor pentru backface culling
+    float coneCutoff;
+};
+
+// Nivel de detaliu: submesh-urile [firstSubmesh, firstSubmesh + submeshCount) din submeshes.
+// error = deviatia geometrica fata de nivelul 0, in unitatile modelului (vezi mesh_lod.h).
+struct MeshLod {
+    GLuint firstSubmesh;
+    GLuint submeshCount;
+    float error;
+};
 
 struct Mesh {
-    GLuint vao, vbo, ebo;
+    GLuint vao;               // VAO-ul arenei comune (vezi geometry_arena.h)
+    GLint baseVertex = 0;     // primul vertex al mesh-ului in VBO-ul arenei
+    size_t firstIndexByte = 0; // inceputul indicilor mesh-ului in EBO-ul arenei
     size_t indexCount;
+    Bounds bounds;
+    std::vector<SubMesh> submeshes;
+    std::vector<MeshLod> lods;
+    std::vector<Meshlet> meshlets;
+    std::string materialLibrary; // mtllib, relativ la directorul .obj
+    std::vector<Material> materials;
+    VertexLayout layout = VertexLayout::Float;
+    // Se aplica inaintea matricei model (dequantizarea pozitiilor pentru VertexLayout::Compact)
+    glm::mat4 positionTransform = glm::mat4(1.0f);
+    GLenum indexType = GL_UNSIGNED_INT;
+
+    // Offset-ul in EBO pentru glDrawElementsBaseVertex, in functie de indexType
+    const void* indexOffset(size_t firstIndex) const { return (const void*)(firstIndexByte + firstIndex * indexSize(indexType)); }
 };
 
-Mesh loadOBJ(const std::string& path);
+// Geometria pe CPU, exact in forma in care e urcata in VBO/EBO.
+// vertexData: pozitie(3) normala(3) texCoord(2) tangenta(4) per vertex.
+const size_t MESH_VERTEX_FLOATS = VERTEX_FLOATS;
+
+struct MeshData {
+    std::vector<float> vertexData;
+    std::vector<GLuint> indices;
+    Bounds bounds;
+    std::vector<SubMesh> submeshes;
+    std::vector<MeshLod> lods;
+    std::vector<Meshlet> meshlets;
+    // Triunghiurile sunt grupate pe material: cate un submesh per material folosit (usemtl),
+    // in ordinea primei aparitii. "" = triunghiurile dinaintea primului usemtl.
+    std::string materialLibrary;
+    std::vector<std::string> materialNames;
+};
+
+struct ObjLoadOptions {
+    bool legacyParser = false; // vechiul parser getline/stringstream, pastrat pentru comparatie
+    unsigned threads = 0;      // thread-uri pentru parsarea pe bucati; 0 = toate nucleele, 1 = secvential
+    bool useCache = true;      // citeste/scrie varianta gatita .spgmesh de langa .obj
+    bool optimize = true;      // reordonare pentru cache-ul post-transform, overdraw si vertex fetch
+    bool generateLods = true;  // lant de LOD-uri simplificate (vezi mesh_lod.h)
+    bool buildMeshlets = true; // meshlet-uri pentru culling pe CPU (vezi meshlet.h)
+    VertexLayout layout = VertexLayout::Float; // formatul din VBO (vezi vertex_format.h)
+};
+
+// Mesh pregatit complet pe CPU: bufferele in formatul final din VBO/EBO si tot ce mai trebuie in Mesh.
+// Se poate construi pe orice thread; doar uploadMesh atinge GL.
+struct MeshUpload {
+    std::vector<unsigned char> vertices; // in formatul layout
+    std::vector<unsigned char> indices;  // in formatul indexType
+    size_t indexCount = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    VertexLayout layout = VertexLayout::Float;
+    PositionDequantization dequantization;
+    Bounds bounds;
+    std::vector<SubMesh> submeshes;
+    std::vector<MeshLod> lods;
+    std::vector<Meshlet> meshlets;
+    std::string materialLibrary;
+    std::vector<Material> materials; // cu caile din .mtl rezolvate, fara texturi
+};
+
+bool parseOBJ(const std::string& path, MeshData& out, const ObjLoadOptions& options = {});
+// Recalculeaza data.bounds si bounds-urile tuturor submesh-urilor (apelat de parseOBJ si buildMeshLods)
+void computeMeshBounds(MeshData& data);
+MeshUpload packMesh(const MeshData& data, VertexLayout layout = VertexLayout::Float);
+Mesh uploadMesh(const MeshData& data, VertexLayout layout = VertexLayout::Float);
+Mesh uploadMesh(const MeshUpload& upload);
+// Rezerva loc in arena de geometrie pentru buffere deja gata; vertices/indices pot fi nullptr
+// (intervalele sunt doar alocate si se completeaza apoi, de ex. pe bucati cu writeGeometryVertices)
+Mesh uploadMeshBuffers(const void* vertices, size_t vertexBytes, const void* indices, size_t indexCount,
+    GLenum indexType, VertexLayout layout = VertexLayout::Float);
+// Copiaza in mesh tot ce nu tine de buffere (submesh-uri, LOD-uri, meshlet-uri, materiale, bounds)
+void copyMeshInfo(const MeshUpload& upload, Mesh& mesh);
+
+// Partea de CPU din loadOBJ (cache, parsare, LOD-uri, optimizare, meshlet-uri, .mtl); fara apeluri GL,
+// deci poate rula pe un thread de fundal (vezi mesh_streaming.h)
+bool prepareOBJ(const std::string& path, const ObjLoadOptions& options, MeshUpload& out);
+Mesh loadOBJ(const std::string& path, const ObjLoadOptions& options = {});
@@ -0,0 +1,234 @@
+#include "occlusion_culling.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define OCCLUSION_CULLING_SSE
+#include <immintrin.h>
+#endif
+
+namespace {
+    // Varfurile cu w mai mic sunt taiate (planul apropiat z = -w nu e suficient cand near e foarte mic)
+    const float MIN_CLIP_W = 1e-5f;
+
+    // Sutherland-Hodgman pe planul apropiat z >= -w; rezulta 0, 3 sau 4 varfuri
+    int clipNear(const glm::vec4 input[3], glm::vec4 output[4]) {
+        int count = 0;
+        for (int i = 0; i < 3; i++) {
+            const glm::vec4& a = input[i];
+            const glm::vec4& b = input[(i + 1) % 3];
+            float da = a.z + a.w, db = b.z + b.w;
+            if (da >= 0.0f) output[count++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f)) output[count++] = a + (b - a) * (da / (da - db));
+        }
+        return count;
+    }
+}
+
+OcclusionBuffer::OcclusionBuffer(int width, int height) {
+    // Nivelul k acopera 2^k x 2^k pixeli din nivelul 0
+    int w = width, h = height;
+    for (;;) {
+        levelWidth.push_back(w);
+        levelHeight.push_back(h);
+        levels.emplace_back((size_t)w * h, 1.0f);
+        if (w == 1 && h == 1) break;
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+    }
+}
+
+OcclusionBuffer::~OcclusionBuffer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+void OcclusionBuffer::setOccluders(const std::vector<glm::vec3>& triangles) {
+    occluders = triangles;
+}
+
+void OcclusionBuffer::setupTriangle(const glm::vec4 clip[3]) {
+    glm::vec3 screen[3];
+    for (int i = 0; i < 3; i++) {
+        float w = std::max(clip[i].w, MIN_CLIP_W);
+        screen[i] = glm::vec3((clip[i].x / w * 0.5f + 0.5f) * width(), (clip[i].y / w * 0.5f + 0.5f) * height(),
+            clip[i].z / w * 0.5f + 0.5f);
+    }
+
+    // Ocluderii sunt vazuti din ambele parti: ordinea varfurilor e adusa la aria pozitiva
+    float area = (screen[1].x - screen[0].x) * (screen[2].y - screen[0].y) - (screen[1].y - screen[0].y) * (screen[2].x - screen[0].x);
+    if (std::abs(area) < 1e-6f) return;
+    if (area < 0.0f) {
+        std::swap(screen[1], screen[2]);
+        area = -area;
+    }
+
+    ScreenTriangle triangle;
+    for (int i = 0; i < 3; i++) {
+        const glm::vec3& a = screen[i];
+        const glm::vec3& b = screen[(i + 1) % 3];
+        triangle.edgeA[i] = a.y - b.y;
+        triangle.edgeB[i] = b.x - a.x;
+        triangle.edgeC[i] = -(triangle.edgeA[i] * a.x + triangle.edgeB[i] * a.y);
+    }
+    // z = z0 + l1 * (z1 - z0) + l2 * (z2 - z0), cu ponderile l1 = edge[2] / area si l2 = edge[0] / area (muchiile opuse)
+    float dz1 = screen[1].z - screen[0].z, dz2 = screen[2].z - screen[0].z;
+    triangle.depthA = (triangle.edgeA[2] * dz1 + triangle.edgeA[0] * dz2) / area;
+    triangle.depthB = (triangle.edgeB[2] * dz1 + triangle.edgeB[0] * dz2) / area;
+    triangle.depthC = screen[0].z + (triangle.edgeC[2] * dz1 + triangle.edgeC[0] * dz2) / area;
+
+    float minX = std::min(std::min(screen[0].x, screen[1].x), screen[2].x);
+    float maxX = std::max(std::max(screen[0].x, screen[1].x), screen[2].x);
+    float minY = std::min(std::min(screen[0].y, screen[1].y), screen[2].y);
+    float maxY = std::max(std::max(screen[0].y, screen[1].y), screen[2].y);
+    triangle.minX = std::max(0, (int)std::floor(minX)) & ~3; // inceputul grupului de 4 pixeli
+    triangle.maxX = std::min(width() - 1, (int)std::ceil(maxX));
+    triangle.minY = std::max(0, (int)std::floor(minY));
+    triangle.maxY = std::min(height() - 1, (int)std::ceil(maxY));
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) return;
+    triangles.push_back(triangle);
+}
+
+void OcclusionBuffer::rasterizeBand(unsigned band) {
+    unsigned bands = OCCLUSION_RASTER_THREADS + 1;
+    int firstRow = height() * band / bands, lastRow = height() * (band + 1) / bands;
+    float* buffer = levels[0].data();
+    std::fill(buffer + (size_t)firstRow * width(), buffer + (size_t)lastRow * width(), 1.0f);
+
+    for (const ScreenTriangle& triangle : triangles) {
+        int y0 = std::max(triangle.minY, firstRow), y1 = std::min(triangle.maxY, lastRow - 1);
+        for (int y = y0; y <= y1; y++) {
+            float py = y + 0.5f;
+            float* row = buffer + (size_t)y * width();
+#ifdef OCCLUSION_CULLING_SSE
+            __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            __m128 edgeStep[3], edgeValue[3];
+            for (int e = 0; e < 3; e++) {
+                __m128 px = _mm_add_ps(_mm_set1_ps((float)triangle.minX), offsets);
+                edgeStep[e] = _mm_set1_ps(triangle.edgeA[e] * 4.0f);
+                edgeValue[e] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.edgeA[e]), px), _mm_set1_ps(triangle.edgeB[e] * py + triangle.edgeC[e]));
+            }
+            __m128 depthStep = _mm_set1_ps(triangle.depthA * 4.0f);
+            __m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.depthA), _mm_add_ps(_mm_set1_ps((float)triangle.minX), offsets)),
+                _mm_set1_ps(triangle.depthB * py + triangle.depthC));
+            for (int x = triangle.minX; x <= triangle.maxX; x += 4) {
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edgeValue[0], _mm_setzero_ps()), _mm_cmpge_ps(edgeValue[1], _mm_setzero_ps())),
+                    _mm_cmpge_ps(edgeValue[2], _mm_setzero_ps()));
+                if (_mm_movemask_ps(inside)) {
+                    __m128 old = _mm_loadu_ps(row + x);
+                    __m128 nearest = _mm_min_ps(old, depth);
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+                }
+                for (int e = 0; e < 3; e++) edgeValue[e] = _mm_add_ps(edgeValue[e], edgeStep[e]);
+                depth = _mm_add_ps(depth, depthStep);
+            }
+#else
+            for (int x = triangle.minX; x <= triangle.maxX; x += 4) {
+                for (int i = 0; i < 4; i++) {
+                    float px = x + i + 0.5f;
+                    bool inside = true;
+                    for (int e = 0; e < 3; e++) inside = inside && triangle.edgeA[e] * px + triangle.edgeB[e] * py + triangle.edgeC[e] >= 0.0f;
+                    if (inside) row[x + i] = std::min(row[x + i], triangle.depthA * px + triangle.depthB * py + triangle.depthC);
+                }
+            }
+#endif
+        }
+    }
+}
+
+void OcclusionBuffer::work(unsigned band) {
+    unsigned seenFrame = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || frame != seenFrame; });
+            if (stopping) return;
+            seenFrame = frame;
+        }
+        rasterizeBand(band);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--bandsRemaining == 0) finished.notify_one();
+    }
+}
+
+void OcclusionBuffer::buildPyramid() {
+    for (size_t level = 1; level < levels.size(); level++) {
+        const std::vector<float>& source = levels[level - 1];
+        int sourceWidth = levelWidth[level - 1], sourceHeight = levelHeight[level - 1];
+        std::vector<float>& target = levels[level];
+        for (int y = 0; y < levelHeight[level]; y++) {
+            int y0 = y * 2, y1 = std::min(y * 2 + 1, sourceHeight - 1);
+            for (int x = 0; x < levelWidth[level]; x++) {
+                int x0 = x * 2, x1 = std::min(x * 2 + 1, sourceWidth - 1);
+                target[(size_t)y * levelWidth[level] + x] = std::max(
+                    std::max(source[(size_t)y0 * sourceWidth + x0], source[(size_t)y0 * sourceWidth + x1]),
+                    std::max(source[(size_t)y1 * sourceWidth + x0], source[(size_t)y1 * sourceWidth + x1]));
+            }
+        }
+    }
+}
+
+void OcclusionBuffer::render(const glm::mat4& matrix) {
+    viewProjection = matrix;
+    triangles.clear();
+    for (size_t i = 0; i + 2 < occluders.size(); i += 3) {
+        glm::vec4 clip[3], clipped[4];
+        for (int v = 0; v < 3; v++) clip[v] = viewProjection * glm::vec4(occluders[i + v], 1.0f);
+        int count = clipNear(clip, clipped);
+        for (int v = 2; v < count; v++) {
+            glm::vec4 fan[3] = { clipped[0], clipped[v - 1], clipped[v] };
+            setupTriangle(fan);
+        }
+    }
+
+    if (workers.empty()) {
+        for (unsigned band = 1; band <= OCCLUSION_RASTER_THREADS; band++) workers.emplace_back(&OcclusionBuffer::work, this, band);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bandsRemaining = OCCLUSION_RASTER_THREADS;
+        frame++;
+    }
+    wake.notify_all();
+    // Banda 0 e rasterizata pe thread-ul apelant
+    rasterizeBand(0);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return bandsRemaining == 0; });
+    }
+    buildPyramid();
+}
+
+bool OcclusionBuffer::isVisible(const Aabb& box) const {
+    glm::vec3 screenMin(1e30f), screenMax(-1e30f);
+    for (int corner = 0; corner < 8; corner++) {
+        glm::vec3 position((corner & 1) ? box.max.x : box.min.x, (corner & 2) ? box.max.y : box.min.y, (corner & 4) ? box.max.z : box.min.z);
+        glm::vec4 clip = viewProjection * glm::vec4(position, 1.0f);
+        // Un colt in spatele planului apropiat: proiectia nu e de incredere
+        if (clip.z < -clip.w || clip.w < MIN_CLIP_W) return true;
+        glm::vec3 screen((clip.x / clip.w * 0.5f + 0.5f) * width(), (clip.y / clip.w * 0.5f + 0.5f) * height(), clip.z / clip.w * 0.5f + 0.5f);
+        screenMin = glm::min(screenMin, screen);
+        screenMax = glm::max(screenMax, screen);
+    }
+
+    int x0 = std::max(0, (int)std::floor(screenMin.x)), x1 = std::min(width() - 1, (int)std::floor(screenMax.x));
+    int y0 = std::max(0, (int)std::floor(screenMin.y)), y1 = std::min(height() - 1, (int)std::floor(screenMax.y));
+    if (x0 > x1 || y0 > y1) return true; // in afara ecranului: decide culling-ul pe frustum
+
+    // Nivelul la care dreptunghiul acopera cel mult 2 x 2 texeli
+    int level = 0;
+    while (level + 1 < levelCount() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)) level++;
+    const std::vector<float>& depths = levels[level];
+    float farthest = 0.0f;
+    for (int y = y0 >> level; y <= (y1 >> level); y++) {
+        for (int x = x0 >> level; x <= (x1 >> level); x++) {
+            farthest = std::max(farthest, depths[(size_t)y * levelWidth[level] + x]);
+        }
+    }
+    return screenMin.z <= farthest;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "bounds.h"
+#include <glm/glm.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Occlusion culling pe CPU: ocluderii mari (peretii, podeaua, tavanul) sunt rasterizati intr-un depth buffer
+// de rezolutie mica, din care se construieste o piramida Hi-Z (fiecare texel = adancimea maxima a celor 4 de sub el).
+// Un AABB e ascuns daca cel mai apropiat punct al lui e in spatele celui mai indepartat ocluder din dreptunghiul
+// pe care il acopera pe ecran. Testul e conservator: la orice dubiu obiectul e considerat vizibil.
+// Rasterizarea e impartita pe benzi orizontale intre OCCLUSION_RASTER_THREADS thread-uri si thread-ul apelant,
+// cate 4 pixeli deodata cu SSE.
+
+const int OCCLUSION_BUFFER_WIDTH = 256; // multiplu de 4
+const int OCCLUSION_BUFFER_HEIGHT = 192;
+const unsigned OCCLUSION_RASTER_THREADS = 3;
+
+class OcclusionBuffer {
+public:
+    OcclusionBuffer(int width = OCCLUSION_BUFFER_WIDTH, int height = OCCLUSION_BUFFER_HEIGHT);
+    ~OcclusionBuffer();
+    OcclusionBuffer(const OcclusionBuffer&) = delete;
+    OcclusionBuffer& operator=(const OcclusionBuffer&) = delete;
+
+    // Triunghiuri in spatiul lumii, cate 3 varfuri; inlocuiesc ocluderii anteriori
+    void setOccluders(const std::vector<glm::vec3>& triangles);
+
+    // Rasterizeaza ocluderii vazuti prin viewProjection si reface piramida; o data pe cadru, inainte de isVisible
+    void render(const glm::mat4& viewProjection);
+
+    // false doar daca AABB-ul (spatiul lumii) e sigur ascuns de ocluderi
+    bool isVisible(const Aabb& box) const;
+
+    int width() const { return levelWidth[0]; }
+    int height() const { return levelHeight[0]; }
+    // Adancimi in [0, 1] (1 = fara ocluder), randul 0 jos
+    const float* depth(int level = 0) const { return levels[level].data(); }
+    int levelCount() const { return (int)levels.size(); }
+
+private:
+    struct ScreenTriangle {
+        float edgeA[3], edgeB[3], edgeC[3]; // edge(x, y) = A * x + B * y + C >= 0 in interior
+        float depthA, depthB, depthC;       // planul adancimii in spatiul ecranului
+        int minX, maxX, minY, maxY;
+    };
+
+    std::vector<glm::vec3> occluders;
+    std::vector<ScreenTriangle> triangles;
+    std::vector<std::vector<float>> levels;
+    std::vector<int> levelWidth, levelHeight;
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+
+    // Thread-urile asteapta un cadru nou, rasterizeaza banda lor si anunta terminarea
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    unsigned frame = 0, bandsRemaining = 0;
+    bool stopping = false;
+
+    void setupTriangle(const glm::vec4 clip[3]);
+    void rasterizeBand(unsigned band);
+    void work(unsigned band);
+    void buildPyramid();
+};
@@ -0,0 +1,132 @@
+#include "portal_visibility.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Cat de aproape de planul unui portal poate fi ochiul pana cand frustum-ul ingustat degenereaza
+    const float PORTAL_PLANE_EPSILON = 1e-3f;
+
+    // Sutherland-Hodgman: pastreaza partea cu dot(n, p) + w >= 0
+    void clipPolygon(std::vector<glm::vec3>& polygon, const glm::vec4& plane, std::vector<glm::vec3>& scratch) {
+        scratch.clear();
+        for (size_t i = 0; i < polygon.size(); i++) {
+            const glm::vec3& a = polygon[i];
+            const glm::vec3& b = polygon[(i + 1) % polygon.size()];
+            float da = glm::dot(glm::vec3(plane), a) + plane.w;
+            float db = glm::dot(glm::vec3(plane), b) + plane.w;
+            if (da >= 0.0f) scratch.push_back(a);
+            if ((da >= 0.0f) != (db >= 0.0f)) scratch.push_back(a + (b - a) * (da / (da - db)));
+        }
+        polygon.swap(scratch);
+    }
+
+    glm::vec3 centroid(const std::vector<glm::vec3>& polygon) {
+        glm::vec3 sum(0.0f);
+        for (const glm::vec3& vertex : polygon) sum += vertex;
+        return sum / (float)polygon.size();
+    }
+
+    // Frustum-ul de la ochi prin poligon (deja taiat), plus planul portalului: ce e intre ochi si portal nu se vede prin el.
+    // Intoarce false daca ochiul e practic in planul portalului; atunci frustum-ul curent ramane neschimbat.
+    bool portalPlanes(const glm::vec3& eye, const std::vector<glm::vec3>& polygon, std::vector<glm::vec4>& planes) {
+        glm::vec3 center = centroid(polygon);
+        glm::vec3 normal(0.0f);
+        for (size_t i = 0; i < polygon.size(); i++) normal += glm::cross(polygon[i], polygon[(i + 1) % polygon.size()]); // Newell
+        float length = glm::length(normal);
+        if (length <= 0.0f) return false;
+        normal /= length;
+        if (glm::dot(normal, center - eye) < 0.0f) normal = -normal;
+        if (glm::dot(normal, center - eye) < PORTAL_PLANE_EPSILON) return false;
+
+        planes.clear();
+        planes.push_back(glm::vec4(normal, -glm::dot(normal, center)));
+        for (size_t i = 0; i < polygon.size(); i++) {
+            glm::vec3 edgeNormal = glm::cross(polygon[i] - eye, polygon[(i + 1) % polygon.size()] - eye);
+            float edgeLength = glm::length(edgeNormal);
+            if (edgeLength < 1e-6f) continue;
+            edgeNormal /= edgeLength;
+            if (glm::dot(edgeNormal, center - eye) < 0.0f) edgeNormal = -edgeNormal;
+            planes.push_back(glm::vec4(edgeNormal, -glm::dot(edgeNormal, eye)));
+        }
+        return true;
+    }
+}
+
+int PortalGraph::addCell(const Aabb& bounds) {
+    cells.push_back({ bounds, {} });
+    return (int)cells.size() - 1;
+}
+
+int PortalGraph::addPortal(const std::vector<glm::vec3>& polygon, int cellA, int cellB) {
+    int portal = (int)portals.size();
+    portals.push_back({ polygon, { cellA, cellB } });
+    if (cellA != PORTAL_EXTERIOR) cells[cellA].portals.push_back(portal);
+    if (cellB != PORTAL_EXTERIOR && cellB != cellA) cells[cellB].portals.push_back(portal);
+    return portal;
+}
+
+int PortalGraph::findCell(const glm::vec3& point) const {
+    for (size_t cell = 0; cell < cells.size(); cell++) {
+        if (contains(cells[cell].bounds, point)) return (int)cell;
+    }
+    return PORTAL_EXTERIOR;
+}
+
+void PortalGraph::computeVisibility(const glm::vec3& eye, const Frustum& frustum, PortalVisibility& visibility) const {
+    visibility.cells.assign(cells.size(), false);
+    visibility.portals.assign(portals.size(), false);
+    visibility.visibleCells.clear();
+
+    int start = findCell(eye);
+    if (start == PORTAL_EXTERIOR) {
+        for (size_t cell = 0; cell < cells.size(); cell++) {
+            if (classifyAabb(frustum, cells[cell].bounds) == FrustumOverlap::Outside) continue;
+            visibility.cells[cell] = true;
+            visibility.visibleCells.push_back((int)cell);
+        }
+        std::fill(visibility.portals.begin(), visibility.portals.end(), true);
+        return;
+    }
+
+    std::vector<glm::vec4> planes(frustum.planes, frustum.planes + 6);
+    std::vector<int> path;
+    // Planul indepartat (ultimul din extractFrustum) e pastrat si dupa ingustare
+    visitCell(start, eye, planes, frustum.planes[5], path, visibility);
+}
+
+void PortalGraph::visitCell(int cell, const glm::vec3& eye, const std::vector<glm::vec4>& planes, const glm::vec4& farPlane,
+    std::vector<int>& path, PortalVisibility& visibility) const {
+    if (!visibility.cells[cell]) {
+        visibility.cells[cell] = true;
+        visibility.visibleCells.push_back(cell);
+    }
+    if ((int)path.size() >= MAX_PORTAL_DEPTH) return;
+
+    std::vector<glm::vec3> polygon, scratch;
+    std::vector<glm::vec4> narrowed;
+    for (int portal : cells[cell].portals) {
+        // Acelasi portal de doua ori pe un drum ar insemna o bucla
+        if (std::find(path.begin(), path.end(), portal) != path.end()) continue;
+
+        polygon = portals[portal].polygon;
+        for (const glm::vec4& plane : planes) {
+            clipPolygon(polygon, plane, scratch);
+            if (polygon.size() < 3) break;
+        }
+        if (polygon.size() < 3) continue;
+        visibility.portals[portal] = true;
+
+        int next = portals[portal].cells[0] == cell ? portals[portal].cells[1] : portals[portal].cells[0];
+        if (next == PORTAL_EXTERIOR) continue;
+
+        path.push_back(portal);
+        if (portalPlanes(eye, polygon, narrowed)) {
+            narrowed.push_back(farPlane);
+            visitCell(next, eye, narrowed, farPlane, path, visibility);
+        }
+        else {
+            visitCell(next, eye, planes, farPlane, path, visibility);
+        }
+        path.pop_back();
+    }
+}
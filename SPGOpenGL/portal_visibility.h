@@ -0,0 +1,52 @@
+#pragma once
+
+#include "bounds.h"
+#include "frustum_culling.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+// Vizibilitate cu celule si portaluri: camerele cladirii sunt celule (AABB), iar usile si ferestrele sunt
+// portaluri (poligoane convexe) intre doua celule sau spre exterior. Din celula in care e ochiul, fiecare portal
+// e taiat cu frustum-ul curent; daca mai ramane ceva din el, celula de dincolo e vizibila si e vizitata cu un
+// frustum ingustat la marginile portalului taiat. Celulele la care nu se ajunge nu se deseneaza deloc.
+
+const int PORTAL_EXTERIOR = -1;   // "celula" de dincolo de o fereastra exterioara
+const int MAX_PORTAL_DEPTH = 32;  // cate portaluri poate traversa un singur drum
+
+struct PortalVisibility {
+    std::vector<bool> cells;       // indexate dupa celula / portal
+    std::vector<bool> portals;
+    std::vector<int> visibleCells; // in ordinea in care au fost gasite
+};
+
+class PortalGraph {
+public:
+    int addCell(const Aabb& bounds);
+    // polygon: varfurile in spatiul lumii, in ordine, convex; cellB poate fi PORTAL_EXTERIOR
+    int addPortal(const std::vector<glm::vec3>& polygon, int cellA, int cellB);
+
+    // Prima celula care contine punctul, sau PORTAL_EXTERIOR
+    int findCell(const glm::vec3& point) const;
+
+    // frustum e frustum-ul camerei. Cu ochiul in afara tuturor celulelor, sunt vizibile toate celulele din frustum.
+    void computeVisibility(const glm::vec3& eye, const Frustum& frustum, PortalVisibility& visibility) const;
+
+    size_t cellCount() const { return cells.size(); }
+    size_t portalCount() const { return portals.size(); }
+
+private:
+    struct Cell {
+        Aabb bounds;
+        std::vector<int> portals;
+    };
+    struct Portal {
+        std::vector<glm::vec3> polygon;
+        int cells[2];
+    };
+
+    std::vector<Cell> cells;
+    std::vector<Portal> portals;
+
+    void visitCell(int cell, const glm::vec3& eye, const std::vector<glm::vec4>& planes, const glm::vec4& farPlane,
+        std::vector<int>& path, PortalVisibility& visibility) const;
+};
@@ -2,11 +2,25 @@
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include <vector>
+#include "vertex_format.h"
+#include "bounds.h"
 
-void initRoom(GLuint wallTex, GLuint wallNorm,
-    GLuint floorTex, GLuint floorNorm,
-    GLuint ceilTex, GLuint ceilNorm,
-    GLuint shader);
+// Fetele camerei: 0 podeaua, 1 tavanul, 2-5 peretii
+const int ROOM_FACE_COUNT = 6;
+const unsigned ALL_ROOM_FACES = (1u << ROOM_FACE_COUNT) - 1;
+
+// Straturile array-urilor de texturi ale camerei (difuze si normal map-uri, in aceeasi ordine)
+const int ROOM_FLOOR_LAYER = 0;
+const int ROOM_CEILING_LAYER = 1;
+const int ROOM_WALL_LAYER = 2;
+const int ROOM_LAYER_COUNT = 3;
+
+// albedoArray / normalArray: GL_TEXTURE_2D_ARRAY cu ROOM_LAYER_COUNT straturi (acquireTextureArray);
+// shader e vertex.vert / fragment.frag compilat cu LAYERED
+void initRoom(GLuint albedoArray, GLuint normalArray,
+    GLuint shader,
+    VertexLayout layout = VertexLayout::Float);
 
 void drawRoom(const glm::mat4& projection,
     const glm::mat4& view,
@@ -17,4 +31,15 @@ void drawRoom(const glm::mat4& projection,
     float lightIntensity,
     const glm::vec3& sunPosition,
     float sunIntensity,
-    float timeOfDay);
\ No newline at end of file
+    float timeOfDay,
+    unsigned faceMask = ALL_ROOM_FACES); // bitul i = fata i e desenata; un apel pentru fiecare interval cu acelasi strat
+
+// Fetele camerei ca desene in batch-ul MDI (draw_batch.h), cu aceiasi parametri de lumina ca drawRoom.
+// false daca array-urile camerei nu au fost adaugate in batch (addBatchTextureArray); atunci se deseneaza cu drawRoom.
+bool addRoomToDrawBatch(float normalMapStrength, unsigned faceMask = ALL_ROOM_FACES);
+
+// Limitele fetei face, in spatiul lumii
+Bounds roomFaceBounds(int face);
+
+// Toate fetele camerei ca triunghiuri in spatiul lumii (cate 3 varfuri), ca ocluderi (occlusion_culling.h)
+std::vector<glm::vec3> roomOccluderTriangles();
\ No newline at end of file
@@ -0,0 +1,333 @@
+#include "scene_bvh.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // Jumatate din aria suprafetei; conteaza doar raporturile
+    float surfaceArea(const Aabb& box) {
+        glm::vec3 size = box.max - box.min;
+        return size.x * size.y + size.y * size.z + size.z * size.x;
+    }
+
+    Aabb merge(const Aabb& a, const Aabb& b) {
+        Aabb box;
+        box.min = glm::min(a.min, b.min);
+        box.max = glm::max(a.max, b.max);
+        return box;
+    }
+
+    bool containsBox(const Aabb& outer, const Aabb& inner) {
+        return glm::all(glm::lessThanEqual(outer.min, inner.min)) && glm::all(glm::greaterThanEqual(outer.max, inner.max));
+    }
+
+    bool overlapsSphere(const Aabb& box, const glm::vec3& center, float radius) {
+        glm::vec3 closest = glm::clamp(center, box.min, box.max);
+        glm::vec3 offset = closest - center;
+        return glm::dot(offset, offset) <= radius * radius;
+    }
+
+    // Metoda slab-urilor; distance = intrarea in cutie (0 daca originea e in interior)
+    bool rayHitsBox(const glm::vec3& origin, const glm::vec3& inverseDirection, const Aabb& box, float maxDistance, float& distance) {
+        glm::vec3 t0 = (box.min - origin) * inverseDirection;
+        glm::vec3 t1 = (box.max - origin) * inverseDirection;
+        glm::vec3 tNear = glm::min(t0, t1), tFar = glm::max(t0, t1);
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+        distance = enter;
+        return enter <= exit;
+    }
+}
+
+int SceneBvh::allocateNode() {
+    if (!freeNodes.empty()) {
+        int node = freeNodes.back();
+        freeNodes.pop_back();
+        nodes[node] = Node();
+        return node;
+    }
+    nodes.emplace_back();
+    return (int)nodes.size() - 1;
+}
+
+void SceneBvh::freeNode(int node) {
+    if (!nodes[node].isLeaf()) internalArea -= surfaceArea(nodes[node].box);
+    freeNodes.push_back(node);
+}
+
+void SceneBvh::setInternalBox(int node, const Aabb& box) {
+    internalArea += surfaceArea(box) - surfaceArea(nodes[node].box);
+    nodes[node].box = box;
+}
+
+void SceneBvh::refitAncestors(int node) {
+    for (; node >= 0; node = nodes[node].parent) {
+        setInternalBox(node, merge(nodes[nodes[node].left].box, nodes[nodes[node].right].box));
+    }
+}
+
+void SceneBvh::insertLeaf(int leaf) {
+    if (root < 0) {
+        root = leaf;
+        nodes[leaf].parent = -1;
+        return;
+    }
+
+    // Fratele cu cel mai mic cost SAH: coboram cat timp un copil e mai ieftin decat un parinte nou aici
+    const Aabb leafBox = nodes[leaf].box;
+    int index = root;
+    while (!nodes[index].isLeaf()) {
+        const Node& node = nodes[index];
+        float combinedArea = surfaceArea(merge(node.box, leafBox));
+        float cost = 2.0f * combinedArea;
+        // Cat creste fiecare stramos daca frunza coboara mai jos
+        float inheritedCost = 2.0f * (combinedArea - surfaceArea(node.box));
+
+        float childCost[2];
+        int children[2] = { node.left, node.right };
+        for (int c = 0; c < 2; c++) {
+            const Node& child = nodes[children[c]];
+            float area = surfaceArea(merge(child.box, leafBox));
+            childCost[c] = (child.isLeaf() ? area : area - surfaceArea(child.box)) + inheritedCost;
+        }
+        if (cost < childCost[0] && cost < childCost[1]) break;
+        index = childCost[0] < childCost[1] ? children[0] : children[1];
+    }
+
+    int sibling = index;
+    int oldParent = nodes[sibling].parent;
+    int newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].left = sibling;
+    nodes[newParent].right = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+    if (oldParent < 0) root = newParent;
+    else if (nodes[oldParent].left == sibling) nodes[oldParent].left = newParent;
+    else nodes[oldParent].right = newParent;
+    refitAncestors(newParent);
+}
+
+void SceneBvh::removeLeaf(int leaf) {
+    if (leaf == root) {
+        root = -1;
+        return;
+    }
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+    freeNode(parent);
+    nodes[leaf].parent = -1;
+
+    nodes[sibling].parent = grandParent;
+    if (grandParent < 0) {
+        root = sibling;
+        return;
+    }
+    if (nodes[grandParent].left == parent) nodes[grandParent].left = sibling;
+    else nodes[grandParent].right = sibling;
+    refitAncestors(grandParent);
+}
+
+BvhHandle SceneBvh::insert(const Aabb& box, uint32_t userData) {
+    BvhHandle handle;
+    if (!freeHandles.empty()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else {
+        handle = (BvhHandle)objects.size();
+        objects.emplace_back();
+    }
+
+    float areaBefore = internalArea;
+    int leaf = allocateNode();
+    nodes[leaf].box = { box.min - glm::vec3(margin), box.max + glm::vec3(margin) };
+    nodes[leaf].handle = handle;
+    objects[handle] = { box, userData, leaf };
+    insertLeaf(leaf);
+    // Suprafata adaugata de obiecte noi nu e degradare, deci nu trebuie sa declanseze reconstructia
+    builtArea += internalArea - areaBefore;
+    return handle;
+}
+
+void SceneBvh::update(BvhHandle handle, const Aabb& box) {
+    Object& object = objects[handle];
+    object.box = box;
+    Node& leaf = nodes[object.node];
+    if (containsBox(leaf.box, box)) return;
+
+    leaf.box = { box.min - glm::vec3(margin), box.max + glm::vec3(margin) };
+    refitAncestors(leaf.parent);
+    if (internalArea > BVH_REBUILD_AREA_RATIO * builtArea) rebuild();
+}
+
+void SceneBvh::remove(BvhHandle handle) {
+    float areaBefore = internalArea;
+    int leaf = objects[handle].node;
+    removeLeaf(leaf);
+    freeNode(leaf);
+    objects[handle].node = -1;
+    freeHandles.push_back(handle);
+    builtArea += internalArea - areaBefore;
+}
+
+int SceneBvh::buildRange(std::vector<BvhHandle>& handles, size_t first, size_t last, int parent) {
+    int node = allocateNode();
+    nodes[node].parent = parent;
+    if (last - first == 1) {
+        BvhHandle handle = handles[first];
+        nodes[node].box = { objects[handle].box.min - glm::vec3(margin), objects[handle].box.max + glm::vec3(margin) };
+        nodes[node].handle = handle;
+        objects[handle].node = node;
+        return node;
+    }
+
+    // Mediana centrelor pe axa cea mai lunga a cutiei centrelor
+    Aabb centers;
+    centers.min = centers.max = objects[handles[first]].box.center();
+    for (size_t i = first + 1; i < last; i++) {
+        glm::vec3 center = objects[handles[i]].box.center();
+        centers.min = glm::min(centers.min, center);
+        centers.max = glm::max(centers.max, center);
+    }
+    glm::vec3 size = centers.max - centers.min;
+    int axis = size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2);
+    size_t middle = (first + last) / 2;
+    std::nth_element(handles.begin() + first, handles.begin() + middle, handles.begin() + last,
+        [&](BvhHandle a, BvhHandle b) { return objects[a].box.center()[axis] < objects[b].box.center()[axis]; });
+
+    int left = buildRange(handles, first, middle, node);
+    int right = buildRange(handles, middle, last, node);
+    nodes[node].left = left;
+    nodes[node].right = right;
+    setInternalBox(node, merge(nodes[left].box, nodes[right].box));
+    return node;
+}
+
+void SceneBvh::rebuild() {
+    std::vector<BvhHandle> handles;
+    handles.reserve(size());
+    for (BvhHandle handle = 0; handle < (BvhHandle)objects.size(); handle++) {
+        if (objects[handle].node >= 0) handles.push_back(handle);
+    }
+
+    nodes.clear();
+    freeNodes.clear();
+    internalArea = 0.0f;
+    root = handles.empty() ? -1 : buildRange(handles, 0, handles.size(), -1);
+    builtArea = internalArea;
+}
+
+int SceneBvh::height() const {
+    if (root < 0) return 0;
+    int result = 0;
+    std::vector<std::pair<int, int>> stack = { { root, 1 } };
+    while (!stack.empty()) {
+        std::pair<int, int> entry = stack.back();
+        stack.pop_back();
+        result = std::max(result, entry.second);
+        if (!nodes[entry.first].isLeaf()) {
+            stack.push_back({ nodes[entry.first].left, entry.second + 1 });
+            stack.push_back({ nodes[entry.first].right, entry.second + 1 });
+        }
+    }
+    return result;
+}
+
+template <typename Overlaps, typename Visit>
+void SceneBvh::traverse(Overlaps overlaps, Visit visit) const {
+    if (root < 0) return;
+    std::vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(root);
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        if (!overlaps(node.box)) continue;
+        if (node.isLeaf()) {
+            visit(node.handle);
+        }
+        else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+void SceneBvh::queryAabb(const Aabb& box, std::vector<BvhHandle>& out) const {
+    out.clear();
+    auto overlaps = [&](const Aabb& nodeBox) { return intersects(nodeBox, box); };
+    traverse(overlaps, [&](BvhHandle handle) {
+        if (overlaps(objects[handle].box)) out.push_back(handle);
+    });
+}
+
+void SceneBvh::querySphere(const glm::vec3& center, float radius, std::vector<BvhHandle>& out) const {
+    out.clear();
+    auto overlaps = [&](const Aabb& nodeBox) { return overlapsSphere(nodeBox, center, radius); };
+    traverse(overlaps, [&](BvhHandle handle) {
+        if (overlaps(objects[handle].box)) out.push_back(handle);
+    });
+}
+
+void SceneBvh::queryFrustum(const Frustum& frustum, std::vector<BvhHandle>& out) const {
+    out.clear();
+    if (root < 0) return;
+    // Al doilea camp: nodul e in intregime in frustum, deci subarborele nu mai e testat
+    std::vector<std::pair<int, bool>> stack;
+    stack.reserve(64);
+    stack.push_back({ root, false });
+    while (!stack.empty()) {
+        std::pair<int, bool> entry = stack.back();
+        stack.pop_back();
+        const Node& node = nodes[entry.first];
+        bool inside = entry.second;
+        if (!inside) {
+            FrustumOverlap overlap = classifyAabb(frustum, node.box);
+            if (overlap == FrustumOverlap::Outside) continue;
+            inside = overlap == FrustumOverlap::Inside;
+        }
+        if (node.isLeaf()) {
+            if (inside || classifyAabb(frustum, objects[node.handle].box) != FrustumOverlap::Outside) out.push_back(node.handle);
+        }
+        else {
+            stack.push_back({ node.left, inside });
+            stack.push_back({ node.right, inside });
+        }
+    }
+}
+
+bool SceneBvh::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, BvhRayHit& hit) const {
+    hit = BvhRayHit();
+    if (root < 0) return false;
+    glm::vec3 inverseDirection = 1.0f / direction;
+    float closest = maxDistance, distance;
+    std::vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(root);
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        if (!rayHitsBox(origin, inverseDirection, node.box, closest, distance)) continue;
+        if (node.isLeaf()) {
+            if (rayHitsBox(origin, inverseDirection, objects[node.handle].box, closest, distance)) {
+                closest = distance;
+                hit.handle = node.handle;
+                hit.distance = distance;
+            }
+            continue;
+        }
+        // Copilul mai apropiat ultimul pe stiva, ca sa fie vizitat primul si sa taie cat mai mult din celalalt
+        float leftDistance = 0.0f, rightDistance = 0.0f;
+        bool hitsLeft = rayHitsBox(origin, inverseDirection, nodes[node.left].box, closest, leftDistance);
+        bool hitsRight = rayHitsBox(origin, inverseDirection, nodes[node.right].box, closest, rightDistance);
+        if (hitsLeft && hitsRight) {
+            bool leftFirst = leftDistance <= rightDistance;
+            stack.push_back(leftFirst ? node.right : node.left);
+            stack.push_back(leftFirst ? node.left : node.right);
+        }
+        else if (hitsLeft) stack.push_back(node.left);
+        else if (hitsRight) stack.push_back(node.right);
+    }
+    return hit.handle != INVALID_BVH_HANDLE;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "bounds.h"
+#include "frustum_culling.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Ierarhie de volume (AABB) peste obiectele scenei, in spatiul lumii, folosita pentru toate interogarile spatiale:
+// frustum, raze, sfera de influenta a unei lumini si coliziunile camerei.
+// Arborele e dinamic: insert/remove in O(log n), iar update doar reface cutiile stramosilor (refit).
+// Frunzele au cutii marite cu margin, deci miscarile mici nu ating arborele. Cand refit-urile degradeaza
+// arborele (suprafata totala a nodurilor creste de BVH_REBUILD_AREA_RATIO ori), e reconstruit de la zero.
+
+const float BVH_REBUILD_AREA_RATIO = 1.5f;
+
+typedef uint32_t BvhHandle;
+const BvhHandle INVALID_BVH_HANDLE = ~0u;
+
+struct BvhRayHit {
+    BvhHandle handle = INVALID_BVH_HANDLE;
+    float distance = 0.0f; // pana la intrarea in AABB-ul obiectului, in unitati de direction
+};
+
+class SceneBvh {
+public:
+    explicit SceneBvh(float margin = 0.1f) : margin(margin) {}
+
+    // userData e al apelantului (de ex. indexul obiectului); handle-ul ramane valabil pana la remove
+    BvhHandle insert(const Aabb& box, uint32_t userData);
+    void update(BvhHandle handle, const Aabb& box);
+    void remove(BvhHandle handle);
+    // Top-down, cu impartire la mediana pe axa cea mai lunga; apelat automat de update cand e nevoie
+    void rebuild();
+
+    uint32_t userData(BvhHandle handle) const { return objects[handle].userData; }
+    const Aabb& bounds(BvhHandle handle) const { return objects[handle].box; }
+    size_t size() const { return objects.size() - freeHandles.size(); }
+    int height() const;
+
+    // Toate golesc out si il umplu cu handle-urile gasite (testate pe cutia exacta, nu pe cea marita)
+    void queryFrustum(const Frustum& frustum, std::vector<BvhHandle>& out) const;
+    void queryAabb(const Aabb& box, std::vector<BvhHandle>& out) const;
+    void querySphere(const glm::vec3& center, float radius, std::vector<BvhHandle>& out) const;
+    // Cel mai apropiat obiect atins de raza in [0, maxDistance]
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, BvhRayHit& hit) const;
+
+private:
+    struct Node {
+        Aabb box;
+        int parent = -1, left = -1, right = -1;
+        BvhHandle handle = INVALID_BVH_HANDLE; // doar la frunze
+        bool isLeaf() const { return left < 0; }
+    };
+    struct Object {
+        Aabb box;
+        uint32_t userData = 0;
+        int node = -1; // -1 = slot liber
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> freeNodes;
+    std::vector<Object> objects;
+    std::vector<BvhHandle> freeHandles;
+    int root = -1;
+    float margin;
+    // Suprafata totala a nodurilor interioare (costul SAH, fara constante) si valoarea ei la ultima reconstructie
+    float internalArea = 0.0f, builtArea = 0.0f;
+
+    int allocateNode();
+    void freeNode(int node);
+    void setInternalBox(int node, const Aabb& box);
+    void refitAncestors(int node);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int buildRange(std::vector<BvhHandle>& handles, size_t first, size_t last, int parent);
+    template <typename Overlaps, typename Visit>
+    void traverse(Overlaps overlaps, Visit visit) const;
+};
@@ -2,6 +2,7 @@
 layout(location=0) in vec3 aPos;
 layout(location=1) in vec3 aNorm;
 layout(location=2) in vec2 aTex;
+layout(location=3) in vec4 aTangent; // w = orientarea bitangentei
 
 uniform mat4 mvpMatrix;
 uniform mat4 modelMatrix;
@@ -26,17 +27,9 @@ void main(){
     // Transform normal to world space
     vs.Normal = normalize((normalMatrix * vec4(aNorm, 0.0)).xyz);
     
-    // Calculate tangent and bitangent for normal mapping
-    vec3 c1 = cross(vs.Normal, vec3(0.0, 0.0, 1.0)); 
-    vec3 c2 = cross(vs.Normal, vec3(0.0, 1.0, 0.0)); 
-    
-    if(length(c1) > length(c2)) {
-        vs.Tangent = c1;
-    } else {
-        vs.Tangent = c2;
-    }
-    vs.Tangent = normalize(vs.Tangent);
-    vs.Bitangent = normalize(cross(vs.Normal, vs.Tangent));
+    // Tangent space generated at load time (MikkTSpace-compatible)
+    vs.Tangent = normalize((normalMatrix * vec4(aTangent.xyz, 0.0)).xyz);
+    vs.Bitangent = cross(vs.Normal, vs.Tangent) * aTangent.w;
     
     vs.TexCoords = aTex;
     
@@ -0,0 +1,87 @@
+#include "texture_cache.h"
+#include <iostream>
+#include <map>
+#include <tuple>
+
+namespace {
+    struct TextureKey {
+        std::string path;
+        GLint wrap;
+        bool mipmaps;
+        bool normalMap; // aceeasi imagine e gatita altfel ca normal map (BC5)
+
+        bool operator<(const TextureKey& other) const {
+            return std::tie(path, wrap, mipmaps, normalMap) < std::tie(other.path, other.wrap, other.mipmaps, other.normalMap);
+        }
+    };
+
+    struct CachedTexture {
+        TextureKey key;
+        size_t bytes;
+        unsigned references;
+    };
+
+    std::map<TextureKey, GLuint> texturesByKey;
+    std::map<GLuint, CachedTexture> cachedTextures;
+    size_t residentBytes = 0;
+
+    template <typename Upload>
+    GLuint acquire(const TextureKey& key, Upload upload) {
+        auto it = texturesByKey.find(key);
+        if (it != texturesByKey.end()) {
+            cachedTextures[it->second].references++;
+            return it->second;
+        }
+
+        size_t bytes = 0;
+        GLuint texture = upload(&bytes);
+        if (!texture) return 0;
+
+        texturesByKey[key] = texture;
+        cachedTextures[texture] = { key, bytes, 1 };
+        residentBytes += bytes;
+        return texture;
+    }
+}
+
+GLuint acquireTexture(const std::string& path, const TextureSampler& sampler) {
+    return acquire({ path, sampler.wrap, sampler.mipmaps, sampler.normalMap }, [&](size_t* bytes) {
+        return uploadTexture(path, sampler, bytes);
+    });
+}
+
+GLuint acquireTextureArray(const std::vector<std::string>& paths, const TextureSampler& sampler) {
+    // Cheia e lista de fisiere; '\n' nu apare in cai, deci nu se confunda cu o textura simpla
+    std::string key;
+    for (const std::string& path : paths) key += path + '\n';
+    return acquire({ key, sampler.wrap, sampler.mipmaps, sampler.normalMap }, [&](size_t* bytes) {
+        return uploadTextureArray(paths, sampler, bytes);
+    });
+}
+
+void retainTexture(GLuint texture) {
+    auto it = cachedTextures.find(texture);
+    if (it != cachedTextures.end()) it->second.references++;
+}
+
+void releaseTexture(GLuint texture) {
+    auto it = cachedTextures.find(texture);
+    if (it == cachedTextures.end()) {
+        if (texture) std::cerr << "releaseTexture: texture " << texture << " is not in the cache" << std::endl;
+        return;
+    }
+    if (--it->second.references > 0) return;
+
+    residentBytes -= it->second.bytes;
+    texturesByKey.erase(it->second.key);
+    cachedTextures.erase(it);
+    glDeleteTextures(1, &texture);
+}
+
+size_t residentTextureCount() {
+    return cachedTextures.size();
+}
+
+size_t residentTextureBytes() {
+    return residentBytes;
+}
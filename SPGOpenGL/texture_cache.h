@@ -0,0 +1,22 @@
+#pragma once
+
+#include "texture_loader.h"
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+
+// Texturile aplicatiei, cheiate dupa fisier si setarile de esantionare. O cerere repetata intoarce textura deja
+// urcata, fara sa mai decodeze imaginea. Fiecare acquireTexture / retainTexture se inchide cu un releaseTexture,
+// iar textura e stearsa cand nu o mai foloseste nimeni. Toate functiile se apeleaza de pe thread-ul GL.
+
+// 0 daca imaginea nu a putut fi citita; in cazul asta nu e nimic de eliberat
+GLuint acquireTexture(const std::string& path, const TextureSampler& sampler = TextureSampler());
+// Array-ul de texturi cu fisierele date ca straturi (uploadTextureArray); se elibereaza tot cu releaseTexture
+GLuint acquireTextureArray(const std::vector<std::string>& paths, const TextureSampler& sampler = TextureSampler());
+
+// Inca o referinta la o textura obtinuta cu acquireTexture (de ex. aceeasi imagine si ca normal map)
+void retainTexture(GLuint texture);
+void releaseTexture(GLuint texture);
+
+size_t residentTextureCount();
+size_t residentTextureBytes(); // pixelii tuturor texturilor din cache, cu tot cu mipmap-uri
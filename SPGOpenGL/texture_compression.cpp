@@ -0,0 +1,280 @@
+#include "texture_compression.h"
+#include "texture_mipmaps.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    const int BLOCK_PIXELS = 16;
+
+    // 4x4 pixeli RGBA incepand de la (x, y); la marginea imaginii se repeta ultimul rand / coloana
+    void readBlock(const unsigned char* rgba, uint32_t width, uint32_t height, uint32_t x, uint32_t y,
+        unsigned char block[BLOCK_PIXELS * 4]) {
+        for (uint32_t by = 0; by < 4; by++) {
+            uint32_t sy = std::min(y + by, height - 1);
+            for (uint32_t bx = 0; bx < 4; bx++) {
+                uint32_t sx = std::min(x + bx, width - 1);
+                memcpy(block + (by * 4 + bx) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+            }
+        }
+    }
+
+    uint16_t packRgb565(const float color[3]) {
+        int r = (int)std::lround(std::min(std::max(color[0], 0.0f), 255.0f) * 31.0f / 255.0f);
+        int g = (int)std::lround(std::min(std::max(color[1], 0.0f), 255.0f) * 63.0f / 255.0f);
+        int b = (int)std::lround(std::min(std::max(color[2], 0.0f), 255.0f) * 31.0f / 255.0f);
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    void unpackRgb565(uint16_t packed, float color[3]) {
+        int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+        color[0] = (float)((r << 3) | (r >> 2));
+        color[1] = (float)((g << 2) | (g >> 4));
+        color[2] = (float)((b << 3) | (b >> 2));
+    }
+
+    // Alege pentru fiecare pixel cea mai apropiata din cele 4 culori ale blocului; intoarce eroarea patratica
+    float pickColorIndices(const unsigned char* block, uint16_t c0, uint16_t c1, uint32_t& indices) {
+        float palette[4][3];
+        unpackRgb565(c0, palette[0]);
+        unpackRgb565(c1, palette[1]);
+        for (int i = 0; i < 3; i++) {
+            palette[2][i] = (2.0f * palette[0][i] + palette[1][i]) / 3.0f;
+            palette[3][i] = (palette[0][i] + 2.0f * palette[1][i]) / 3.0f;
+        }
+
+        float error = 0.0f;
+        indices = 0;
+        for (int p = 0; p < BLOCK_PIXELS; p++) {
+            float best = 1e30f;
+            uint32_t bestIndex = 0;
+            for (uint32_t index = 0; index < 4; index++) {
+                float d = 0.0f;
+                for (int i = 0; i < 3; i++) {
+                    float diff = block[p * 4 + i] - palette[index][i];
+                    d += diff * diff;
+                }
+                if (d < best) {
+                    best = d;
+                    bestIndex = index;
+                }
+            }
+            indices |= bestIndex << (2 * p);
+            error += best;
+        }
+        return error;
+    }
+
+    // c0 > c1 pastreaza blocul in modul cu 4 culori; schimbarea capetelor inverseaza indecsii (0<->1, 2<->3)
+    void orderEndpoints(uint16_t& c0, uint16_t& c1, uint32_t& indices) {
+        if (c0 < c1) {
+            std::swap(c0, c1);
+            indices ^= 0x55555555;
+        }
+        else if (c0 == c1) {
+            indices = 0;
+        }
+    }
+
+    // Capetele prin cele mai mici patrate, pentru indecsii deja alesi
+    bool refineEndpoints(const unsigned char* block, uint32_t indices, float start[3], float end[3]) {
+        const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+        float ax[3] = {}, bx[3] = {};
+        for (int p = 0; p < BLOCK_PIXELS; p++) {
+            float w = weights[(indices >> (2 * p)) & 3];
+            aa += w * w;
+            bb += (1.0f - w) * (1.0f - w);
+            ab += w * (1.0f - w);
+            for (int i = 0; i < 3; i++) {
+                ax[i] += w * block[p * 4 + i];
+                bx[i] += (1.0f - w) * block[p * 4 + i];
+            }
+        }
+        float determinant = aa * bb - ab * ab;
+        if (std::fabs(determinant) < 1e-6f) return false;
+        for (int i = 0; i < 3; i++) {
+            start[i] = (ax[i] * bb - bx[i] * ab) / determinant;
+            end[i] = (bx[i] * aa - ax[i] * ab) / determinant;
+        }
+        return true;
+    }
+
+    // Bloc de culoare BC1 (8 octeti): capetele pe axa principala a culorilor din bloc, apoi o rafinare
+    void encodeColorBlock(const unsigned char* block, unsigned char* out) {
+        float mean[3] = {}, low[3] = { 255, 255, 255 }, high[3] = {};
+        for (int p = 0; p < BLOCK_PIXELS; p++) {
+            for (int i = 0; i < 3; i++) {
+                float c = block[p * 4 + i];
+                mean[i] += c;
+                low[i] = std::min(low[i], c);
+                high[i] = std::max(high[i], c);
+            }
+        }
+        for (int i = 0; i < 3; i++) mean[i] /= BLOCK_PIXELS;
+
+        float covariance[6] = {}; // rr, rg, rb, gg, gb, bb
+        for (int p = 0; p < BLOCK_PIXELS; p++) {
+            float r = block[p * 4] - mean[0], g = block[p * 4 + 1] - mean[1], b = block[p * 4 + 2] - mean[2];
+            covariance[0] += r * r; covariance[1] += r * g; covariance[2] += r * b;
+            covariance[3] += g * g; covariance[4] += g * b; covariance[5] += b * b;
+        }
+
+        // Axa principala prin cateva iteratii ale metodei puterii, pornind de la diagonala cutiei de culori
+        float axis[3] = { high[0] - low[0], high[1] - low[1], high[2] - low[2] };
+        for (int iteration = 0; iteration < 4; iteration++) {
+            float next[3] = {
+                covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+                covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+                covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2],
+            };
+            float length = std::max(std::fabs(next[0]), std::max(std::fabs(next[1]), std::fabs(next[2])));
+            if (length < 1e-6f) break;
+            for (int i = 0; i < 3; i++) axis[i] = next[i] / length;
+        }
+        float axisLength = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+        float start[3], end[3];
+        if (axisLength < 1e-6f) {
+            // Bloc de o singura culoare
+            memcpy(start, mean, sizeof(start));
+            memcpy(end, mean, sizeof(end));
+        }
+        else {
+            float minT = 1e30f, maxT = -1e30f;
+            for (int p = 0; p < BLOCK_PIXELS; p++) {
+                float t = 0.0f;
+                for (int i = 0; i < 3; i++) t += (block[p * 4 + i] - mean[i]) * axis[i];
+                minT = std::min(minT, t);
+                maxT = std::max(maxT, t);
+            }
+            // Capetele putin spre interior: extremele sunt de obicei zgomot, iar interpolarile acopera mai bine restul
+            float inset = (maxT - minT) / 16.0f;
+            minT += inset;
+            maxT -= inset;
+            for (int i = 0; i < 3; i++) {
+                start[i] = mean[i] + axis[i] * maxT / axisLength;
+                end[i] = mean[i] + axis[i] * minT / axisLength;
+            }
+        }
+
+        uint16_t c0 = packRgb565(start), c1 = packRgb565(end);
+        uint32_t indices;
+        float error = pickColorIndices(block, c0, c1, indices);
+
+        float refinedStart[3], refinedEnd[3];
+        if (c0 != c1 && refineEndpoints(block, indices, refinedStart, refinedEnd)) {
+            uint16_t r0 = packRgb565(refinedStart), r1 = packRgb565(refinedEnd);
+            uint32_t refinedIndices;
+            if (pickColorIndices(block, r0, r1, refinedIndices) < error) {
+                c0 = r0;
+                c1 = r1;
+                indices = refinedIndices;
+            }
+        }
+        orderEndpoints(c0, c1, indices);
+
+        out[0] = (unsigned char)(c0 & 0xFF); out[1] = (unsigned char)(c0 >> 8);
+        out[2] = (unsigned char)(c1 & 0xFF); out[3] = (unsigned char)(c1 >> 8);
+        for (int i = 0; i < 4; i++) out[4 + i] = (unsigned char)(indices >> (8 * i));
+    }
+
+    // Bloc BC4 (8 octeti) pentru un canal: capetele sunt minimul si maximul, cu 6 valori interpolate intre ele
+    void encodeChannelBlock(const unsigned char* block, int channel, unsigned char* out) {
+        int low = 255, high = 0;
+        for (int p = 0; p < BLOCK_PIXELS; p++) {
+            low = std::min(low, (int)block[p * 4 + channel]);
+            high = std::max(high, (int)block[p * 4 + channel]);
+        }
+        out[0] = (unsigned char)high;
+        out[1] = (unsigned char)low;
+
+        uint64_t indices = 0;
+        if (high > low) {
+            int palette[8] = { high, low };
+            for (int j = 2; j < 8; j++) palette[j] = ((8 - j) * high + (j - 1) * low) / 7;
+            for (int p = 0; p < BLOCK_PIXELS; p++) {
+                int value = block[p * 4 + channel];
+                int bestIndex = 0, best = 256;
+                for (int j = 0; j < 8; j++) {
+                    int d = std::abs(value - palette[j]);
+                    if (d < best) {
+                        best = d;
+                        bestIndex = j;
+                    }
+                }
+                indices |= (uint64_t)bestIndex << (3 * p);
+            }
+        }
+        for (int i = 0; i < 6; i++) out[2 + i] = (unsigned char)(indices >> (8 * i));
+    }
+
+    void encodeLevel(const unsigned char* rgba, uint32_t width, uint32_t height, GLenum format, unsigned char* out) {
+        size_t blockBytes = format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 8 : 16;
+        unsigned char block[BLOCK_PIXELS * 4];
+        for (uint32_t y = 0; y < height; y += 4) {
+            for (uint32_t x = 0; x < width; x += 4, out += blockBytes) {
+                readBlock(rgba, width, height, x, y, block);
+                if (format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) {
+                    encodeColorBlock(block, out);
+                }
+                else if (format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT) {
+                    encodeChannelBlock(block, 3, out);
+                    encodeColorBlock(block, out + 8);
+                }
+                else {
+                    encodeChannelBlock(block, 0, out);
+                    encodeChannelBlock(block, 1, out + 8);
+                }
+            }
+        }
+    }
+}
+
+bool textureCompressionSupported() {
+    return GLEW_EXT_texture_compression_s3tc && (GLEW_VERSION_3_0 || GLEW_ARB_texture_compression_rgtc);
+}
+
+bool isCompressedFormat(GLenum internalFormat) {
+    return internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT ||
+        internalFormat == GL_COMPRESSED_RG_RGTC2;
+}
+
+uint64_t cookedLevelBytes(GLenum internalFormat, uint32_t width, uint32_t height) {
+    if (!isCompressedFormat(internalFormat)) return (uint64_t)width * height * 4;
+    return (uint64_t)((width + 3) / 4) * ((height + 3) / 4) * (internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 8 : 16);
+}
+
+void cookTexture(const unsigned char* rgba, uint32_t width, uint32_t height, bool normalMap, bool mipmaps, bool compress,
+    bool alpha, CookedTexture& out) {
+    out = CookedTexture();
+    out.width = width;
+    out.height = height;
+    if (!compress) {
+        out.internalFormat = GL_RGBA8;
+    }
+    else if (normalMap) {
+        out.internalFormat = GL_COMPRESSED_RG_RGTC2;
+    }
+    else {
+        bool opaque = !alpha;
+        for (size_t i = 3; i < (size_t)width * height * 4 && opaque; i += 4) opaque = rgba[i] == 255;
+        out.internalFormat = opaque ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    }
+
+    std::vector<MipLevel> mips;
+    if (mipmaps) generateMipChain(rgba, width, height, normalMap, mips);
+
+    for (size_t level = 0; level <= mips.size(); level++) {
+        const unsigned char* pixels = level == 0 ? rgba : mips[level - 1].rgba.data();
+        CookedLevel cooked;
+        cooked.width = level == 0 ? width : mips[level - 1].width;
+        cooked.height = level == 0 ? height : mips[level - 1].height;
+        cooked.offset = out.data.size();
+        cooked.size = cookedLevelBytes(out.internalFormat, cooked.width, cooked.height);
+        out.data.resize(out.data.size() + cooked.size);
+        if (compress) encodeLevel(pixels, cooked.width, cooked.height, out.internalFormat, &out.data[cooked.offset]);
+        else memcpy(&out.data[cooked.offset], pixels, cooked.size);
+        out.levels.push_back(cooked);
+    }
+}
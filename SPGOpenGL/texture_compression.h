@@ -0,0 +1,35 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+
+// Textura gatita pe CPU, gata de urcat nivel cu nivel. Comprimata in formatele bloc ale GPU-ului (blocuri de 4x4 pixeli):
+// BC1 (DXT1, 8 octeti/bloc) pentru culori opace, BC3 (DXT5, 16 octeti) cand exista transparenta,
+// BC5 (RGTC2, 16 octeti) pentru normal map-uri: doar x si y, z se reface in shader.
+// Fara compresie, nivelurile raman GL_RGBA8. Nu apeleaza GL, deci merge pe thread-urile de decodare.
+
+struct CookedLevel {
+    uint32_t width, height;
+    uint64_t offset, size; // in CookedTexture::data
+};
+
+struct CookedTexture {
+    // GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_COMPRESSED_RG_RGTC2 sau GL_RGBA8
+    GLenum internalFormat = 0;
+    uint32_t width = 0, height = 0;
+    std::vector<CookedLevel> levels; // nivelul 0 primul
+    std::vector<unsigned char> data;
+};
+
+// Contextul GL curent stie sa citeasca formatele comprimate de mai sus (S3TC si RGTC)
+bool textureCompressionSupported();
+
+// rgba: width x height pixeli RGBA8. Cu mipmaps, nivelurile pana la 1x1 vin din generateMipChain (texture_mipmaps.h).
+// Cu alpha, culorile sunt BC3 chiar daca imaginea e opaca, ca toate straturile unui array sa aiba acelasi format.
+void cookTexture(const unsigned char* rgba, uint32_t width, uint32_t height, bool normalMap, bool mipmaps, bool compress,
+    bool alpha, CookedTexture& out);
+
+bool isCompressedFormat(GLenum internalFormat);
+// Octetii unui nivel de width x height pixeli in formatul dat
+uint64_t cookedLevelBytes(GLenum internalFormat, uint32_t width, uint32_t height);
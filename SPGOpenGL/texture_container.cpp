@@ -0,0 +1,144 @@
+#include "texture_container.h"
+#include "mapped_file.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    const char TEXTURE_CONTAINER_MAGIC[8] = { 'S', 'P', 'G', 'T', 'E', 'X', 0, 0 };
+    const uint32_t TEXTURE_CONTAINER_VERSION = 2;
+    const uint32_t TEXTURE_CONTAINER_MAX_LEVELS = 32;
+
+    struct TextureContainerHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+        uint64_t sourceHash;
+        uint32_t flags;
+        uint32_t glInternalFormat;
+        uint32_t width;
+        uint32_t height;
+        uint32_t levelCount;
+        uint32_t reserved;
+        uint64_t levelOffset;    // tabela de TextureContainerLevel
+        uint64_t fileSize;
+    };
+
+    struct TextureContainerLevel {
+        uint32_t width, height;
+        uint64_t offset, size; // de la inceputul fisierului
+    };
+
+    uint64_t alignUp(uint64_t value) {
+        return (value + 15) & ~uint64_t(15);
+    }
+
+    bool knownFormat(uint32_t format) {
+        return isCompressedFormat(format) || format == GL_RGBA8;
+    }
+}
+
+std::string textureContainerPath(const std::string& sourcePath, uint32_t flags) {
+    std::string options;
+    if (flags & TEXTURE_CONTAINER_NORMAL_MAP) options += 'n';
+    if (flags & TEXTURE_CONTAINER_MIPMAPS) options += 'm';
+    if (flags & TEXTURE_CONTAINER_COMPRESSED) options += 'c';
+    if (flags & TEXTURE_CONTAINER_ALPHA) options += 'a';
+    return options.empty() ? sourcePath + ".spgtex" : sourcePath + "." + options + ".spgtex";
+}
+
+bool loadTextureContainer(const std::string& containerPath, uint64_t sourceHash, uint32_t flags, CookedTexture& out) {
+    MappedFile file(containerPath);
+    if (!file.isOpen() || file.size() < sizeof(TextureContainerHeader)) return false;
+
+    TextureContainerHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, TEXTURE_CONTAINER_MAGIC, sizeof(TEXTURE_CONTAINER_MAGIC)) != 0 ||
+        header.version != TEXTURE_CONTAINER_VERSION ||
+        header.headerSize != sizeof(TextureContainerHeader) ||
+        header.fileSize != file.size()) {
+        return false;
+    }
+    if (header.sourceHash != sourceHash || header.flags != flags) {
+        std::cout << "Texture container out of date: " << containerPath << std::endl;
+        return false;
+    }
+    if (!knownFormat(header.glInternalFormat) || header.levelCount == 0 ||
+        header.levelCount > TEXTURE_CONTAINER_MAX_LEVELS ||
+        header.levelOffset + (uint64_t)header.levelCount * sizeof(TextureContainerLevel) > file.size()) {
+        return false;
+    }
+
+    const TextureContainerLevel* levels = (const TextureContainerLevel*)(file.data() + header.levelOffset);
+    uint64_t dataStart = levels[0].offset, dataEnd = dataStart;
+    for (uint32_t i = 0; i < header.levelCount; i++) {
+        uint64_t expected = cookedLevelBytes(header.glInternalFormat, levels[i].width, levels[i].height);
+        if (levels[i].size != expected || levels[i].offset < dataEnd || levels[i].offset + levels[i].size > file.size()) {
+            return false;
+        }
+        dataEnd = levels[i].offset + levels[i].size;
+    }
+
+    // Nivelurile sunt scrise unul dupa altul, deci se copiaza dintr-o bucata
+    out = CookedTexture();
+    out.internalFormat = header.glInternalFormat;
+    out.width = header.width;
+    out.height = header.height;
+    out.data.assign(file.data() + dataStart, file.data() + dataEnd);
+    for (uint32_t i = 0; i < header.levelCount; i++) {
+        out.levels.push_back({ levels[i].width, levels[i].height, levels[i].offset - dataStart, levels[i].size });
+    }
+    return true;
+}
+
+bool writeTextureContainer(const std::string& containerPath, uint64_t sourceHash, uint32_t flags, const CookedTexture& texture) {
+    if (texture.levels.empty() || texture.levels.size() > TEXTURE_CONTAINER_MAX_LEVELS) return false;
+
+    TextureContainerHeader header = {};
+    memcpy(header.magic, TEXTURE_CONTAINER_MAGIC, sizeof(TEXTURE_CONTAINER_MAGIC));
+    header.version = TEXTURE_CONTAINER_VERSION;
+    header.headerSize = sizeof(TextureContainerHeader);
+    header.sourceHash = sourceHash;
+    header.flags = flags;
+    header.glInternalFormat = texture.internalFormat;
+    header.width = texture.width;
+    header.height = texture.height;
+    header.levelCount = (uint32_t)texture.levels.size();
+    header.levelOffset = alignUp(sizeof(TextureContainerHeader));
+
+    uint64_t dataOffset = alignUp(header.levelOffset + texture.levels.size() * sizeof(TextureContainerLevel));
+    std::vector<TextureContainerLevel> levels;
+    for (const CookedLevel& level : texture.levels) {
+        levels.push_back({ level.width, level.height, dataOffset + level.offset, level.size });
+    }
+    header.fileSize = dataOffset + texture.data.size();
+
+    // Scriem intr-un fisier temporar si il redenumim, ca un fisier scris pe jumatate sa nu fie citit
+    std::string tempPath = containerPath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        const char padding[16] = {};
+        auto writeAt = [&](uint64_t offset, const void* bytes, size_t size) {
+            uint64_t position = (uint64_t)out.tellp();
+            if (offset > position) out.write(padding, (std::streamsize)(offset - position));
+            if (size) out.write((const char*)bytes, (std::streamsize)size);
+        };
+
+        writeAt(0, &header, sizeof(header));
+        writeAt(header.levelOffset, levels.data(), levels.size() * sizeof(TextureContainerLevel));
+        writeAt(dataOffset, texture.data.data(), texture.data.size());
+        if (!out) return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, containerPath, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    std::cout << "Wrote texture container: " << containerPath << std::endl;
+    return true;
+}
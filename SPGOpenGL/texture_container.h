@@ -0,0 +1,21 @@
+#pragma once
+
+#include "texture_compression.h"
+#include <cstdint>
+#include <string>
+
+// Fisier .spgtex, dupa modelul KTX: formatul intern GL, dimensiunile, tabela de niveluri si datele fiecarui mipmap
+// (blocuri comprimate sau RGBA8), aliniate la 16 octeti, plus hash-ul imaginii sursa. Nivelurile se urca asa cum sunt.
+
+// Cum a fost gatita textura; un fisier scris cu alte optiuni e regenerat.
+const uint32_t TEXTURE_CONTAINER_NORMAL_MAP = 1 << 0;
+const uint32_t TEXTURE_CONTAINER_MIPMAPS = 1 << 1;
+const uint32_t TEXTURE_CONTAINER_COMPRESSED = 1 << 2;
+const uint32_t TEXTURE_CONTAINER_ALPHA = 1 << 3; // strat de array: BC3 si pentru imaginile opace
+
+// Langa sursa, cu extensia ei si optiunile in nume (foo.jpg.nmc.spgtex), ca fiecare varianta sa aiba fisierul ei
+std::string textureContainerPath(const std::string& sourcePath, uint32_t flags);
+
+// Nu apeleaza GL, deci merg si pe thread-urile de decodare
+bool loadTextureContainer(const std::string& containerPath, uint64_t sourceHash, uint32_t flags, CookedTexture& out);
+bool writeTextureContainer(const std::string& containerPath, uint64_t sourceHash, uint32_t flags, const CookedTexture& texture);
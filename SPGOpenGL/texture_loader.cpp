@@ -0,0 +1,315 @@
+#include "texture_loader.h"
+#include "texture_compression.h"
+#include "texture_container.h"
+#include "mapped_file.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct DecodedImage {
+        std::string path;
+        uint32_t flags = 0; // TEXTURE_CONTAINER_*; compresia e decisa pe thread-ul GL, dupa extensiile suportate
+        CookedTexture texture;
+        bool done = false;
+        double decodeMs = 0.0;
+    };
+
+    double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    typedef std::pair<std::string, uint32_t> ImageKey;
+
+    // Se apeleaza pe thread-ul GL. Straturile de array color sunt toate BC3, ca sa aiba acelasi format.
+    uint32_t containerFlags(const TextureSampler& sampler, bool arrayLayer = false) {
+        bool compress = textureCompressionSupported();
+        return (sampler.normalMap ? TEXTURE_CONTAINER_NORMAL_MAP : 0) | (sampler.mipmaps ? TEXTURE_CONTAINER_MIPMAPS : 0) |
+            (compress ? TEXTURE_CONTAINER_COMPRESSED : 0) |
+            (compress && arrayLayer && !sampler.normalMap ? TEXTURE_CONTAINER_ALPHA : 0);
+    }
+
+    // Nivelurile vin din .spgtex daca acesta corespunde sursei; altfel sunt gatite acum (mipmap-uri, compresie) si scrise pe disc
+    void decode(DecodedImage& image) {
+        auto start = std::chrono::steady_clock::now();
+        MappedFile source(image.path);
+        if (source.isOpen()) {
+            uint64_t sourceHash = hashBytes(source.data(), source.size());
+            std::string containerPath = textureContainerPath(image.path, image.flags);
+            if (!loadTextureContainer(containerPath, sourceHash, image.flags, image.texture)) {
+                int width, height, components;
+                unsigned char* rgba = stbi_load_from_memory((const stbi_uc*)source.data(), (int)source.size(),
+                    &width, &height, &components, 4);
+                if (rgba) {
+                    cookTexture(rgba, (uint32_t)width, (uint32_t)height, (image.flags & TEXTURE_CONTAINER_NORMAL_MAP) != 0,
+                        (image.flags & TEXTURE_CONTAINER_MIPMAPS) != 0, (image.flags & TEXTURE_CONTAINER_COMPRESSED) != 0,
+                        (image.flags & TEXTURE_CONTAINER_ALPHA) != 0, image.texture);
+                    stbi_image_free(rgba);
+                    if (!writeTextureContainer(containerPath, sourceHash, image.flags, image.texture)) {
+                        std::cerr << "Could not write texture container: " << containerPath << std::endl;
+                    }
+                }
+            }
+        }
+        image.decodeMs = elapsedMs(start);
+    }
+
+    struct TextureDecoder {
+        std::mutex mutex;
+        std::condition_variable wake, decoded;
+        std::deque<std::shared_ptr<DecodedImage>> requests;
+        std::map<ImageKey, std::shared_ptr<DecodedImage>> images; // cerute si inca neurcate
+        std::vector<std::thread> workers;
+        bool stopping = false;
+
+        ~TextureDecoder() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (std::thread& worker : workers) worker.join();
+        }
+
+        void work() {
+            for (;;) {
+                std::shared_ptr<DecodedImage> image;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock, [this] { return stopping || !requests.empty(); });
+                    if (stopping) return;
+                    image = requests.front();
+                    requests.pop_front();
+                }
+                decode(*image);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                image->done = true;
+                decoded.notify_all();
+            }
+        }
+    };
+
+    TextureDecoder& decoder() {
+        static TextureDecoder instance;
+        return instance;
+    }
+
+    void prefetchImage(const std::string& path, uint32_t flags) {
+        TextureDecoder& d = decoder();
+        std::lock_guard<std::mutex> lock(d.mutex);
+        if (d.workers.empty()) {
+            // Starea e globala in stb_image, deci e setata o singura data, inainte sa porneasca thread-urile
+            stbi_set_flip_vertically_on_load(true);
+            for (unsigned i = 0; i < TEXTURE_DECODE_THREADS; i++) d.workers.emplace_back(&TextureDecoder::work, &d);
+        }
+        ImageKey key(path, flags);
+        if (d.images.count(key)) return;
+
+        std::shared_ptr<DecodedImage> image(new DecodedImage());
+        image->path = path;
+        image->flags = flags;
+        d.images[key] = image;
+        d.requests.push_back(image);
+        d.wake.notify_one();
+    }
+}
+
+void prefetchTexture(const std::string& path, const TextureSampler& sampler) {
+    prefetchImage(path, containerFlags(sampler));
+}
+
+void prefetchTextureArray(const std::vector<std::string>& paths, const TextureSampler& sampler) {
+    for (const std::string& path : paths) prefetchImage(path, containerFlags(sampler, true));
+}
+
+namespace {
+    // Imaginea ceruta, gatita: din prefetch (asteptand cat mai e nevoie) sau decodata pe loc
+    std::shared_ptr<DecodedImage> takeImage(const std::string& path, uint32_t flags, bool& prefetched) {
+        TextureDecoder& d = decoder();
+        std::shared_ptr<DecodedImage> image;
+        {
+            std::unique_lock<std::mutex> lock(d.mutex);
+            auto it = d.images.find(ImageKey(path, flags));
+            if (it != d.images.end()) {
+                image = it->second;
+                d.images.erase(it);
+                d.decoded.wait(lock, [&] { return image->done; });
+            }
+        }
+        prefetched = image != nullptr;
+        if (!prefetched) {
+            image.reset(new DecodedImage());
+            image->path = path;
+            image->flags = flags;
+            if (d.workers.empty()) stbi_set_flip_vertically_on_load(true);
+            decode(*image);
+        }
+        return image;
+    }
+
+    void setSamplerParameters(GLenum target, const TextureSampler& sampler, size_t levelCount) {
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, (GLint)levelCount - 1);
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, sampler.wrap);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, sampler.wrap);
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, sampler.mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+    // Strat neted (alb, sau normala (0, 0, 1)) in locul unei imagini care lipseste sau nu se potriveste in array
+    std::shared_ptr<DecodedImage> fallbackLayer(const std::string& path, uint32_t flags, uint32_t width, uint32_t height) {
+        bool normalMap = (flags & TEXTURE_CONTAINER_NORMAL_MAP) != 0;
+        std::vector<unsigned char> rgba((size_t)width * height * 4, 255);
+        if (normalMap) {
+            for (size_t i = 0; i < rgba.size(); i += 4) rgba[i] = rgba[i + 1] = 128;
+        }
+        std::shared_ptr<DecodedImage> image(new DecodedImage());
+        image->path = path;
+        image->flags = flags;
+        cookTexture(rgba.data(), width, height, normalMap, (flags & TEXTURE_CONTAINER_MIPMAPS) != 0,
+            (flags & TEXTURE_CONTAINER_COMPRESSED) != 0, (flags & TEXTURE_CONTAINER_ALPHA) != 0, image->texture);
+        return image;
+    }
+
+    // Castigul e decodarea care s-a suprapus cu alta munca: cat ar fi stat thread-ul GL minus cat a stat
+    void reportDecode(const DecodedImage& image, double waitedMs) {
+        std::cout << "Texture " << image.path << ": decoded in " << image.decodeMs << " ms, waited " << waitedMs
+            << " ms, saved " << std::max(0.0, image.decodeMs - waitedMs) << " ms" << std::endl;
+    }
+}
+
+GLuint uploadTexture(const std::string& path, const TextureSampler& sampler, size_t* residentBytes) {
+    auto start = std::chrono::steady_clock::now();
+    bool prefetched;
+    std::shared_ptr<DecodedImage> image = takeImage(path, containerFlags(sampler), prefetched);
+    double waitedMs = elapsedMs(start);
+
+    const CookedTexture& texture = image->texture;
+    if (texture.levels.empty()) {
+        std::cerr << "Failed to load texture: " << path << std::endl;
+        return 0;
+    }
+
+    // Mipmap-urile sunt deja gatite, nu se mai genereaza pe GPU
+    GLuint id;
+    glGenTextures(1, &id);
+    glBindTexture(GL_TEXTURE_2D, id);
+    bool compressed = isCompressedFormat(texture.internalFormat);
+    for (size_t level = 0; level < texture.levels.size(); level++) {
+        const CookedLevel& data = texture.levels[level];
+        if (compressed) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, texture.internalFormat, data.width, data.height, 0,
+                (GLsizei)data.size, &texture.data[data.offset]);
+        }
+        else {
+            glTexImage2D(GL_TEXTURE_2D, (GLint)level, GL_RGBA8, data.width, data.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                &texture.data[data.offset]);
+        }
+    }
+    setSamplerParameters(GL_TEXTURE_2D, sampler, texture.levels.size());
+
+    if (residentBytes) *residentBytes = texture.data.size();
+    if (prefetched) reportDecode(*image, waitedMs);
+    return id;
+}
+
+GLuint uploadTextureArray(const std::vector<std::string>& paths, const TextureSampler& sampler, size_t* residentBytes) {
+    if (paths.empty()) return 0;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<DecodedImage>> images;
+    std::vector<bool> prefetched(paths.size());
+    uint32_t flags = containerFlags(sampler, true);
+    for (size_t i = 0; i < paths.size(); i++) {
+        bool wasPrefetched;
+        images.push_back(takeImage(paths[i], flags, wasPrefetched));
+        prefetched[i] = wasPrefetched;
+    }
+    double waitedMs = elapsedMs(start);
+
+    // Straturile au aceeasi latura: a celei mai mici imagini. Cele mai mari incep de la mipmap-ul de aceeasi dimensiune.
+    // Formatul e al primei imagini incarcate; cu flags de strat ar trebui sa fie acelasi la toate.
+    uint32_t width = 0, height = 0;
+    GLenum internalFormat = 0;
+    for (const auto& image : images) {
+        if (image->texture.levels.empty()) {
+            std::cerr << "Failed to load texture: " << image->path << std::endl;
+            continue;
+        }
+        if (!internalFormat) internalFormat = image->texture.internalFormat;
+        if (!width || image->texture.width < width) {
+            width = image->texture.width;
+            height = image->texture.height;
+        }
+    }
+    if (!width) return 0;
+
+    // O imagine care lipseste sau nu se potriveste e inlocuita cu un strat neted, nu strica tot array-ul
+    std::vector<size_t> firstLevel(images.size());
+    size_t levelCount = ~size_t(0);
+    for (size_t i = 0; i < images.size(); i++) {
+        const CookedTexture& texture = images[i]->texture;
+        size_t level = 0;
+        while (level < texture.levels.size() &&
+            (texture.levels[level].width != width || texture.levels[level].height != height)) {
+            level++;
+        }
+        if (texture.internalFormat != internalFormat || level == texture.levels.size()) {
+            if (!texture.levels.empty()) {
+                std::cerr << "Texture array: " << images[i]->path << " does not match the other layers (format or size)"
+                    << ", using a flat layer" << std::endl;
+            }
+            images[i] = fallbackLayer(images[i]->path, flags, width, height);
+            prefetched[i] = false;
+            level = 0;
+        }
+        else if (level > 0) {
+            std::cout << "Texture array: " << images[i]->path << " downscaled from " << texture.width << "x"
+                << texture.height << " to " << width << "x" << height << std::endl;
+        }
+        firstLevel[i] = level;
+        levelCount = std::min(levelCount, images[i]->texture.levels.size() - level);
+    }
+
+    // Fiecare nivel e urcat dintr-o bucata: acelasi nivel al tuturor straturilor, unul dupa altul
+    GLuint id;
+    glGenTextures(1, &id);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+    bool compressed = isCompressedFormat(internalFormat);
+    GLsizei layers = (GLsizei)images.size();
+    std::vector<unsigned char> levelData;
+    size_t bytes = 0;
+    for (size_t level = 0; level < levelCount; level++) {
+        levelData.clear();
+        for (size_t i = 0; i < images.size(); i++) {
+            const CookedTexture& texture = images[i]->texture;
+            const CookedLevel& data = texture.levels[firstLevel[i] + level];
+            levelData.insert(levelData.end(), texture.data.begin() + data.offset, texture.data.begin() + data.offset + data.size);
+        }
+        const CookedLevel& size = images[0]->texture.levels[firstLevel[0] + level];
+        if (compressed) {
+            glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, (GLint)level, internalFormat, size.width, size.height, layers, 0,
+                (GLsizei)levelData.size(), levelData.data());
+        }
+        else {
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, (GLint)level, GL_RGBA8, size.width, size.height, layers, 0, GL_RGBA,
+                GL_UNSIGNED_BYTE, levelData.data());
+        }
+        bytes += levelData.size();
+    }
+    setSamplerParameters(GL_TEXTURE_2D_ARRAY, sampler, levelCount);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    if (residentBytes) *residentBytes = bytes;
+    for (size_t i = 0; i < images.size(); i++) {
+        if (prefetched[i]) reportDecode(*images[i], waitedMs);
+    }
+    return id;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+
+// Decodarea imaginilor (stb_image) pe un pool de thread-uri, ca sa nu astepte fiecare JPEG dupa cel dinainte.
+// prefetchTexture porneste decodarea in fundal; uploadTexture, pe thread-ul GL, asteapta doar cat mai e nevoie
+// si urca pixelii. Imaginile sunt intoarse vertical, ca pentru texCoord-urile OpenGL.
+// Thread-urile calculeaza si mipmap-urile (texture_mipmaps.h) si, cand GPU-ul suporta S3TC/RGTC, comprima nivelurile
+// in BC1/BC3/BC5. Rezultatul e pastrat intr-un .spgtex langa sursa; la pornirile urmatoare se citeste direct fisierul gatit.
+// Ambele functii se apeleaza de pe thread-ul GL.
+
+const unsigned TEXTURE_DECODE_THREADS = 4;
+
+// Setarile de esantionare cu care e urcata o textura
+struct TextureSampler {
+    GLint wrap = GL_REPEAT;
+    bool mipmaps = true; // filtrare triliniara; fara mipmap-uri doar GL_LINEAR
+    bool normalMap = false; // comprimata BC5 (doar x si y); shaderul reface z
+};
+
+// Poate fi apelat de mai multe ori pentru acelasi fisier; se decodeaza o singura data pana la uploadTexture.
+// sampler trebuie sa fie cel cu care se va cere textura, pentru ca de el depinde compresia.
+void prefetchTexture(const std::string& path, const TextureSampler& sampler = TextureSampler());
+// La fel, pentru straturile unui uploadTextureArray (sunt gatite toate in acelasi format)
+void prefetchTextureArray(const std::vector<std::string>& paths, const TextureSampler& sampler = TextureSampler());
+
+// Textura noua cu setarile date, sau 0 daca imaginea nu a putut fi citita. residentBytes primeste memoria ocupata pe GPU.
+// Un fisier cerut fara prefetch e decodat pe loc. Scrie in consola cat a durat decodarea si cat s-a castigat.
+// De obicei se apeleaza prin acquireTexture (texture_cache.h), care nu urca acelasi fisier de doua ori.
+GLuint uploadTexture(const std::string& path, const TextureSampler& sampler = TextureSampler(), size_t* residentBytes = nullptr);
+
+// Un GL_TEXTURE_2D_ARRAY cu cate un strat pentru fiecare fisier, in ordine, ca un mesh cu mai multe texturi sa se
+// deseneze fara sa schimbe texturile intre fete. Culorile sunt gatite toate BC3, ca straturile sa aiba acelasi format,
+// iar latura e a celei mai mici imagini: una mai mare incepe de la mipmap-ul de aceeasi dimensiune (scrie in consola).
+// O imagine care lipseste sau tot nu se potriveste devine un strat neted; 0 doar daca nu s-a putut citi niciuna.
+GLuint uploadTextureArray(const std::vector<std::string>& paths, const TextureSampler& sampler = TextureSampler(),
+    size_t* residentBytes = nullptr);
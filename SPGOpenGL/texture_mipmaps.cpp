@@ -0,0 +1,209 @@
+#include "texture_mipmaps.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define TEXTURE_MIPMAPS_SSE
+#include <immintrin.h>
+#endif
+
+namespace {
+    const float KAISER_ALPHA = 4.0f;
+    const float KAISER_RADIUS = 2.0f; // in pixeli ai nivelului mic, deci 4 pixeli sursa de fiecare parte
+    const float PI = 3.14159265358979f;
+
+    double besselI0(double x) {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 32; k++) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    float kaiser(float x) {
+        if (std::fabs(x) >= KAISER_RADIUS) return 0.0f;
+        float sinc = x == 0.0f ? 1.0f : std::sin(PI * x) / (PI * x);
+        float t = x / KAISER_RADIUS;
+        return sinc * (float)(besselI0(KAISER_ALPHA * std::sqrt(1.0f - t * t)) / besselI0(KAISER_ALPHA));
+    }
+
+    // Ponderile unei treceri 1D: pentru fiecare pixel destinatie, `taps` indecsi sursa (limitati la margine)
+    struct Filter1D {
+        int taps;
+        std::vector<int> indices;
+        std::vector<float> weights;
+    };
+
+    Filter1D makeFilter(uint32_t srcSize, uint32_t dstSize) {
+        float scale = (float)srcSize / dstSize;
+        Filter1D filter;
+        filter.taps = (int)std::ceil(2.0f * KAISER_RADIUS * scale) + 1;
+        filter.indices.resize((size_t)dstSize * filter.taps);
+        filter.weights.resize((size_t)dstSize * filter.taps);
+        for (uint32_t d = 0; d < dstSize; d++) {
+            float center = (d + 0.5f) * scale;
+            int first = (int)std::floor(center - KAISER_RADIUS * scale);
+            float sum = 0.0f;
+            for (int k = 0; k < filter.taps; k++) {
+                int i = first + k;
+                float w = kaiser((i + 0.5f - center) / scale);
+                filter.indices[d * filter.taps + k] = std::min(std::max(i, 0), (int)srcSize - 1);
+                filter.weights[d * filter.taps + k] = w;
+                sum += w;
+            }
+            for (int k = 0; k < filter.taps; k++) filter.weights[d * filter.taps + k] /= sum;
+        }
+        return filter;
+    }
+
+    const int SRGB_BUCKETS = 4096;
+
+    // sRGB <-> liniar. Inapoi se cauta printre pragurile dintre doua coduri sRGB vecine, deci rezultatul e exact;
+    // o tabela pe intervale egale in spatiul liniar da codul de pornire, iar de acolo mai sunt cel mult cativa pasi.
+    struct SrgbTables {
+        float toLinear[256];
+        float thresholds[256]; // ultimul e o santinela
+        unsigned char firstCode[SRGB_BUCKETS];
+
+        SrgbTables() {
+            for (int i = 0; i < 256; i++) toLinear[i] = decode(i / 255.0f);
+            for (int i = 0; i < 255; i++) thresholds[i] = decode((i + 0.5f) / 255.0f);
+            thresholds[255] = 2.0f;
+            for (int bucket = 0; bucket < SRGB_BUCKETS; bucket++) {
+                firstCode[bucket] = (unsigned char)(std::upper_bound(thresholds, thresholds + 255, (float)bucket / SRGB_BUCKETS) - thresholds);
+            }
+        }
+
+        static float decode(float c) {
+            return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+
+        unsigned char encode(float linear) const {
+            linear = std::min(std::max(linear, 0.0f), 1.0f);
+            int code = firstCode[std::min((int)(linear * SRGB_BUCKETS), SRGB_BUCKETS - 1)];
+            while (thresholds[code] <= linear) code++;
+            return (unsigned char)code;
+        }
+    };
+
+    const SrgbTables& srgbTables() {
+        static SrgbTables tables;
+        return tables;
+    }
+
+    unsigned char toByte(float value) {
+        return (unsigned char)std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f);
+    }
+
+    // Sub atat alpha filtrat e considerat transparent si culoarea nu mai poate fi refacuta
+    const float MIN_FILTERED_ALPHA = 0.5f / 255.0f;
+
+    // Randul sursa y, in spatiul in care se filtreaza: normala in [-1, 1] sau culoare liniara inmultita cu alpha,
+    // ca texelii transparenti sa nu-si verse culoarea in marginile nivelurilor mici; alpha in [0, 1]
+    void loadRow(const unsigned char* src, uint32_t width, bool normalMap, float* row) {
+        const SrgbTables& srgb = srgbTables();
+        for (uint32_t x = 0; x < width; x++, src += 4, row += 4) {
+            row[3] = src[3] / 255.0f;
+            for (int i = 0; i < 3; i++) row[i] = normalMap ? src[i] / 127.5f - 1.0f : srgb.toLinear[src[i]] * row[3];
+        }
+    }
+
+    void filterRow(const float* src, const Filter1D& filter, uint32_t dstWidth, float* dst) {
+        for (uint32_t x = 0; x < dstWidth; x++, dst += 4) {
+            const int* indices = &filter.indices[x * filter.taps];
+            const float* weights = &filter.weights[x * filter.taps];
+#ifdef TEXTURE_MIPMAPS_SSE
+            __m128 sum = _mm_setzero_ps();
+            for (int k = 0; k < filter.taps; k++) {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(src + 4 * indices[k])));
+            }
+            _mm_storeu_ps(dst, sum);
+#else
+            for (int i = 0; i < 4; i++) dst[i] = 0.0f;
+            for (int k = 0; k < filter.taps; k++) {
+                for (int i = 0; i < 4; i++) dst[i] += weights[k] * src[4 * indices[k] + i];
+            }
+#endif
+        }
+    }
+
+    // Un nivel din cel anterior. Randurile filtrate orizontal stau intr-un inel cat fereastra verticala,
+    // deci memoria suplimentara e doar cateva randuri, nu imaginea intreaga in float.
+    void downsample(const unsigned char* src, uint32_t width, uint32_t height, bool normalMap, MipLevel& dst) {
+        dst.width = std::max(1u, width / 2);
+        dst.height = std::max(1u, height / 2);
+        dst.rgba.resize((size_t)dst.width * dst.height * 4);
+        Filter1D horizontal = makeFilter(width, dst.width);
+        Filter1D vertical = makeFilter(height, dst.height);
+
+        size_t rowFloats = (size_t)dst.width * 4;
+        int ringSize = vertical.taps + 2;
+        std::vector<float> ring(ringSize * rowFloats), sourceRow((size_t)width * 4), sum(rowFloats);
+        std::vector<int> ringRows(ringSize, -1);
+        std::vector<const float*> rows(vertical.taps);
+        const SrgbTables& srgb = srgbTables();
+
+        for (uint32_t y = 0; y < dst.height; y++) {
+            for (int k = 0; k < vertical.taps; k++) {
+                int sourceY = vertical.indices[y * vertical.taps + k];
+                int slot = sourceY % ringSize;
+                if (ringRows[slot] != sourceY) {
+                    loadRow(src + (size_t)sourceY * width * 4, width, normalMap, sourceRow.data());
+                    filterRow(sourceRow.data(), horizontal, dst.width, &ring[slot * rowFloats]);
+                    ringRows[slot] = sourceY;
+                }
+                rows[k] = &ring[slot * rowFloats];
+            }
+
+            const float* weights = &vertical.weights[y * vertical.taps];
+            for (size_t x = 0; x < rowFloats; x += 4) {
+#ifdef TEXTURE_MIPMAPS_SSE
+                __m128 value = _mm_setzero_ps();
+                for (int k = 0; k < vertical.taps; k++) {
+                    value = _mm_add_ps(value, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + x)));
+                }
+                _mm_storeu_ps(&sum[x], value);
+#else
+                for (int i = 0; i < 4; i++) {
+                    sum[x + i] = 0.0f;
+                    for (int k = 0; k < vertical.taps; k++) sum[x + i] += weights[k] * rows[k][x + i];
+                }
+#endif
+            }
+
+            unsigned char* out = &dst.rgba[(size_t)y * dst.width * 4];
+            for (size_t x = 0; x < rowFloats; x += 4, out += 4) {
+                const float* pixel = &sum[x];
+                if (normalMap) {
+                    float length = std::sqrt(pixel[0] * pixel[0] + pixel[1] * pixel[1] + pixel[2] * pixel[2]);
+                    for (int i = 0; i < 3; i++) {
+                        float n = length > 1e-6f ? pixel[i] / length : (i == 2 ? 1.0f : 0.0f);
+                        out[i] = toByte((n + 1.0f) * 0.5f);
+                    }
+                }
+                else {
+                    float alpha = pixel[3];
+                    for (int i = 0; i < 3; i++) out[i] = alpha > MIN_FILTERED_ALPHA ? srgb.encode(pixel[i] / alpha) : 0;
+                }
+                out[3] = toByte(pixel[3]);
+            }
+        }
+    }
+}
+
+void generateMipChain(const unsigned char* rgba, uint32_t width, uint32_t height, bool normalMap, std::vector<MipLevel>& levels) {
+    levels.clear();
+    // Nivelul anterior e sursa urmatorului, deci vectorul nu are voie sa se realoce pe parcurs
+    size_t count = 0;
+    for (uint32_t w = width, h = height; w > 1 || h > 1; w = std::max(1u, w / 2), h = std::max(1u, h / 2)) count++;
+    levels.reserve(count);
+    const unsigned char* source = rgba;
+    while (width > 1 || height > 1) {
+        levels.emplace_back();
+        downsample(source, width, height, normalMap, levels.back());
+        source = levels.back().rgba.data();
+        width = levels.back().width;
+        height = levels.back().height;
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Mipmap-uri calculate pe CPU, in locul glGenerateMipmap la fiecare pornire: fiecare nivel e injumatatit din cel
+// anterior cu un filtru Kaiser separabil (sinc ferestruit). Culorile sunt filtrate in lumina liniara (pixelii sunt sRGB)
+// si ponderate cu alpha (premultiplicate, apoi impartite inapoi), alpha direct, iar normalele ca vectori, renormalizati.
+// Nu apeleaza GL, deci merge pe thread-urile de decodare.
+
+struct MipLevel {
+    uint32_t width, height;
+    std::vector<unsigned char> rgba;
+};
+
+// Nivelurile 1..n, pana la 1x1, ale imaginii RGBA8 date (nivelul 0 e imaginea insasi)
+void generateMipChain(const unsigned char* rgba, uint32_t width, uint32_t height, bool normalMap, std::vector<MipLevel>& levels);
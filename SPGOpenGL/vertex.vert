@@ -2,10 +2,35 @@
 layout(location=0) in vec3 aPos;
 layout(location=1) in vec3 aNorm;
 layout(location=2) in vec2 aTex;
+layout(location=3) in vec4 aTangent; // w = orientarea bitangentei
 
+#ifdef BATCHED
+// Date per desen pentru glMultiDrawElementsIndirect (vezi draw_batch.h)
+struct DrawData {
+    mat4 modelMatrix;
+    mat4 normalMatrix;
+    ivec2 layers;
+    float normalMapStrength;
+    float lightIntensityOffset;
+};
+layout(std430, binding = 0) readonly buffer DrawDataBuffer { DrawData draws[]; };
+layout(std430, binding = 1) readonly buffer DrawIndexBuffer { uint drawIndices[]; };
+uniform int drawCommandOffset;
+uniform mat4 viewProjection;
+flat out int drawIndex;
+#elif defined(INSTANCED)
+// Copiile unui mesh pentru glDrawElementsInstanced (vezi mesh_instancing.h)
+struct InstanceData {
+    mat4 modelMatrix;
+    mat4 normalMatrix;
+};
+layout(std430, binding = 2) readonly buffer InstanceBuffer { InstanceData instances[]; };
+uniform mat4 viewProjection;
+#else
 uniform mat4 mvpMatrix;
 uniform mat4 modelMatrix;
 uniform mat4 normalMatrix;
+#endif
 
 out VS_OUT {
     vec3  FragPos;
@@ -16,19 +41,22 @@ out VS_OUT {
 } vs;
 
 void main(){
+#ifdef BATCHED
+    drawIndex = int(drawIndices[drawCommandOffset + gl_DrawIDARB]);
+    mat4 modelMatrix = draws[drawIndex].modelMatrix;
+    mat4 normalMatrix = draws[drawIndex].normalMatrix;
+    mat4 mvpMatrix = viewProjection * modelMatrix;
+#elif defined(INSTANCED)
+    mat4 modelMatrix = instances[gl_InstanceID].modelMatrix;
+    mat4 normalMatrix = instances[gl_InstanceID].normalMatrix;
+    mat4 mvpMatrix = viewProjection * modelMatrix;
+#endif
     vs.FragPos = (modelMatrix * vec4(aPos, 1.0)).xyz;
     vs.Normal = normalize((normalMatrix * vec4(aNorm, 0.0)).xyz);
-
-    vec3 c1 = cross(vs.Normal, vec3(0.0, 0.0, 1.0)); 
-    vec3 c2 = cross(vs.Normal, vec3(0.0, 1.0, 0.0)); 
-    
-    if(length(c1) > length(c2)) {
-        vs.Tangent = c1;
-    } else {
-        vs.Tangent = c2;
-    }
-    vs.Tangent = normalize(vs.Tangent);
-    vs.Bitangent = normalize(cross(vs.Normal, vs.Tangent));
+    // modelMatrix contine si dequantizarea pozitiilor, deci tangenta trece tot prin normalMatrix
+    // (identic pentru rotatii si scalari uniforme)
+    vs.Tangent = normalize((normalMatrix * vec4(aTangent.xyz, 0.0)).xyz);
+    vs.Bitangent = cross(vs.Normal, vs.Tangent) * aTangent.w;
     
     vs.TexCoords = aTex;
     gl_Position = mvpMatrix * vec4(aPos, 1.0);
@@ -0,0 +1,190 @@
+#include "vertex_format.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <cmath>
+
+namespace {
+    const size_t FLOATS_PER_VERTEX = VERTEX_FLOATS;
+
+    struct CompactVertex {
+        uint16_t position[4];
+        uint32_t normal;
+        uint32_t texCoord;
+        uint32_t tangent;
+    };
+    static_assert(sizeof(CompactVertex) == 20, "CompactVertex trebuie sa aiba 20 de octeti");
+
+    uint16_t quantizeUnorm16(float v) {
+        v = glm::clamp(v, 0.0f, 1.0f);
+        return (uint16_t)std::lround(v * 65535.0f);
+    }
+
+    uint32_t quantizeSnorm10(float v) {
+        v = glm::clamp(v, -1.0f, 1.0f);
+        return (uint32_t)(std::lround(v * 511.0f)) & 0x3FF;
+    }
+
+    float dequantizeSnorm10(uint32_t bits) {
+        int value = (int)(bits << 22) >> 22; // extindere de semn pe 10 biti
+        return std::max(value / 511.0f, -1.0f);
+    }
+
+    uint32_t packNormal(const glm::vec3& n) {
+        return quantizeSnorm10(n.x) | (quantizeSnorm10(n.y) << 10) | (quantizeSnorm10(n.z) << 20);
+    }
+
+    // Tangenta in 10/10/10 biti, orientarea +-1 in cei 2 biti de sus (snorm: 01 = 1, 11 = -1)
+    uint32_t packTangent(const glm::vec3& t, float w) {
+        return packNormal(t) | ((w < 0.0f ? 3u : 1u) << 30);
+    }
+
+    glm::vec3 unpackNormal(uint32_t packed) {
+        return glm::vec3(dequantizeSnorm10(packed & 0x3FF),
+            dequantizeSnorm10((packed >> 10) & 0x3FF),
+            dequantizeSnorm10((packed >> 20) & 0x3FF));
+    }
+
+    PositionDequantization computeDequantization(const float* vertexData, size_t vertexCount) {
+        PositionDequantization dequantization;
+        if (vertexCount == 0) return dequantization;
+
+        glm::vec3 lo(vertexData[0], vertexData[1], vertexData[2]);
+        glm::vec3 hi = lo;
+        for (size_t v = 0; v < vertexCount; v++) {
+            const float* p = vertexData + v * FLOATS_PER_VERTEX;
+            lo = glm::min(lo, glm::vec3(p[0], p[1], p[2]));
+            hi = glm::max(hi, glm::vec3(p[0], p[1], p[2]));
+        }
+
+        dequantization.offset = lo;
+        dequantization.scale = hi - lo;
+        for (int i = 0; i < 3; i++) {
+            if (dequantization.scale[i] <= 0.0f) dequantization.scale[i] = 1.0f;
+        }
+        return dequantization;
+    }
+}
+
+glm::mat4 PositionDequantization::matrix() const {
+    return glm::scale(glm::translate(glm::mat4(1.0f), offset), scale);
+}
+
+size_t vertexStride(VertexLayout layout) {
+    return layout == VertexLayout::Compact ? sizeof(CompactVertex) : FLOATS_PER_VERTEX * sizeof(float);
+}
+
+void setupVertexAttributes(VertexLayout layout) {
+    GLsizei stride = (GLsizei)vertexStride(layout);
+
+    if (layout == VertexLayout::Compact) {
+        // Position (unorm16, dequantizata prin matricea model)
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)offsetof(CompactVertex, position));
+        // Normal (vec3 in shader, w ignorat)
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(CompactVertex, normal));
+        // TexCoords
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(CompactVertex, texCoord));
+        // Tangent (xyz + orientarea in w)
+        glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(CompactVertex, tangent));
+    }
+    else {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void*)(8 * sizeof(float)));
+    }
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glEnableVertexAttribArray(3);
+}
+
+std::vector<unsigned char> packVertices(const float* vertexData, size_t vertexCount, VertexLayout layout,
+    PositionDequantization& dequantization) {
+    std::vector<unsigned char> bytes(vertexCount * vertexStride(layout));
+
+    if (layout == VertexLayout::Float) {
+        dequantization = PositionDequantization();
+        if (vertexCount) memcpy(bytes.data(), vertexData, bytes.size());
+        return bytes;
+    }
+
+    dequantization = computeDequantization(vertexData, vertexCount);
+    CompactVertex* out = (CompactVertex*)bytes.data();
+    for (size_t v = 0; v < vertexCount; v++) {
+        const float* p = vertexData + v * FLOATS_PER_VERTEX;
+        glm::vec3 unit = (glm::vec3(p[0], p[1], p[2]) - dequantization.offset) / dequantization.scale;
+
+        CompactVertex& cv = out[v];
+        cv.position[0] = quantizeUnorm16(unit.x);
+        cv.position[1] = quantizeUnorm16(unit.y);
+        cv.position[2] = quantizeUnorm16(unit.z);
+        cv.position[3] = 0;
+        cv.normal = packNormal(glm::vec3(p[3], p[4], p[5]));
+        cv.texCoord = glm::packHalf2x16(glm::vec2(p[6], p[7]));
+        cv.tangent = packTangent(glm::vec3(p[8], p[9], p[10]), p[11]);
+    }
+    return bytes;
+}
+
+GLenum chooseIndexType(size_t vertexCount) {
+    return vertexCount <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+size_t indexSize(GLenum indexType) {
+    return indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+}
+
+std::vector<unsigned char> packIndices(const GLuint* indices, size_t indexCount, GLenum indexType) {
+    std::vector<unsigned char> bytes(indexCount * indexSize(indexType));
+    if (indexType == GL_UNSIGNED_SHORT) {
+        GLushort* out = (GLushort*)bytes.data();
+        for (size_t i = 0; i < indexCount; i++) out[i] = (GLushort)indices[i];
+    }
+    else if (indexCount) {
+        memcpy(bytes.data(), indices, bytes.size());
+    }
+    return bytes;
+}
+
+void reportQuantizationError(const std::string& name, const float* vertexData, size_t vertexCount) {
+    if (vertexCount == 0) return;
+
+    PositionDequantization dequantization;
+    std::vector<unsigned char> bytes = packVertices(vertexData, vertexCount, VertexLayout::Compact, dequantization);
+    const CompactVertex* packed = (const CompactVertex*)bytes.data();
+
+    float maxPositionError = 0.0f, maxNormalDegrees = 0.0f, maxTexCoordError = 0.0f, maxTangentDegrees = 0.0f;
+    size_t handednessErrors = 0;
+
+    auto angleDegrees = [](const glm::vec3& a, const glm::vec3& b) {
+        if (glm::length(a) <= 0.0f || glm::length(b) <= 0.0f) return 0.0f;
+        float cosine = glm::clamp(glm::dot(glm::normalize(a), glm::normalize(b)), -1.0f, 1.0f);
+        return glm::degrees(std::acos(cosine));
+    };
+    for (size_t v = 0; v < vertexCount; v++) {
+        const float* p = vertexData + v * FLOATS_PER_VERTEX;
+        const CompactVertex& cv = packed[v];
+
+        glm::vec3 unit(cv.position[0] / 65535.0f, cv.position[1] / 65535.0f, cv.position[2] / 65535.0f);
+        glm::vec3 position = dequantization.offset + unit * dequantization.scale;
+        maxPositionError = std::max(maxPositionError, glm::length(position - glm::vec3(p[0], p[1], p[2])));
+
+        maxNormalDegrees = std::max(maxNormalDegrees, angleDegrees(glm::vec3(p[3], p[4], p[5]), unpackNormal(cv.normal)));
+        maxTangentDegrees = std::max(maxTangentDegrees, angleDegrees(glm::vec3(p[8], p[9], p[10]), unpackNormal(cv.tangent)));
+        if (((cv.tangent >> 30) == 3) != (p[11] < 0.0f)) handednessErrors++;
+
+        glm::vec2 texCoord = glm::unpackHalf2x16(cv.texCoord);
+        maxTexCoordError = std::max(maxTexCoordError, glm::length(texCoord - glm::vec2(p[6], p[7])));
+    }
+
+    float diagonal = glm::length(dequantization.scale);
+    std::cout << "Compact vertices for " << name << ": " << vertexCount * vertexStride(VertexLayout::Float) / 1024.0
+        << " KB -> " << bytes.size() / 1024.0 << " KB, max error: position " << maxPositionError
+        << " (" << (diagonal > 0.0f ? maxPositionError / diagonal * 100.0f : 0.0f) << "% of bounds), normal "
+        << maxNormalDegrees << " deg, texCoord " << maxTexCoordError << ", tangent " << maxTangentDegrees << " deg";
+    if (handednessErrors) std::cout << " (" << handednessErrors << " handedness errors)";
+    std::cout << std::endl;
+}
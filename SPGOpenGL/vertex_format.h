@@ -0,0 +1,48 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Formatul vertecsilor din VBO. Locatiile atributelor sunt aceleasi (0 pozitie, 1 normala,
+// 2 texCoord, 3 tangenta cu w = orientarea), deci vertex.vert si shadow.vert nu se schimba.
+//  Float:   pozitie 3 x float, normala 3 x float, texCoord 2 x float,
+//           tangenta 4 x float                                              = 48 octeti
+//  Compact: pozitie 4 x unorm16 (w nefolosit), normala 2_10_10_10 snorm,
+//           texCoord 2 x half, tangenta 2_10_10_10 snorm (w pe 2 biti)      = 20 octeti
+enum class VertexLayout : uint32_t {
+    Float = 0,
+    Compact = 1,
+};
+
+// Pozitiile compacte sunt in [0,1] pe fiecare axa in interiorul AABB-ului mesh-ului;
+// matrix() le aduce inapoi in spatiul modelului si se inmulteste la dreapta matricei model.
+struct PositionDequantization {
+    glm::vec3 offset = glm::vec3(0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+
+    glm::mat4 matrix() const;
+};
+
+// Vertecsii pe CPU: pozitie(3) normala(3) texCoord(2) tangenta(4)
+const size_t VERTEX_FLOATS = 12;
+
+size_t vertexStride(VertexLayout layout);
+
+// Seteaza atributele 0/1/2/3 pentru VAO-ul si VBO-ul legate in acest moment
+void setupVertexAttributes(VertexLayout layout);
+
+// vertexData: cate VERTEX_FLOATS float-uri per vertex
+std::vector<unsigned char> packVertices(const float* vertexData, size_t vertexCount, VertexLayout layout,
+    PositionDequantization& dequantization);
+
+// Tipul indicilor din EBO: GL_UNSIGNED_SHORT daca toti vertecsii sunt adresabili pe 16 biti,
+// altfel GL_UNSIGNED_INT. Fara primitive restart, deci si 0xFFFF e un index valid.
+GLenum chooseIndexType(size_t vertexCount);
+size_t indexSize(GLenum indexType);
+std::vector<unsigned char> packIndices(const GLuint* indices, size_t indexCount, GLenum indexType);
+
+// Eroarea maxima introdusa de formatul compact, fata de datele float originale
+void reportQuantizationError(const std::string& name, const float* vertexData, size_t vertexCount);
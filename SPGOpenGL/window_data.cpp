@@ -7,10 +7,18 @@
 #include <fstream>
 #include <iostream>
 
-#include "stb_image.h"
+#include "texture_cache.h"
+#include "mesh_tangents.h"
+#include "geometry_arena.h"
+#include "bounds.h"
+#include <vector>
+#include <algorithm>
 using namespace std;
 
-GLuint windowVAO, windowVBO, windowEBO;
+GeometryRange windowGeometry;
+glm::mat4 windowPositionTransform = glm::mat4(1.0f);
+Bounds windowBoundsData[WINDOW_COUNT];
+vector<glm::vec3> windowPolygons[WINDOW_COUNT];
 GLuint windowShaderProgram;
 GLuint windowFrameTex, landscape1Tex, landscape2Tex;
 
@@ -39,35 +47,9 @@ namespace {
 
         return sh;
     }
-
-    GLuint loadTexture(const char* path) {
-        GLuint id;
-        glGenTextures(1, &id);
-        int w, h, comp;
-        stbi_set_flip_vertically_on_load(true);
-        unsigned char* data = stbi_load(path, &w, &h, &comp, 0);
-
-        if (!data) {
-            cerr << "Failed to load texture: " << path << endl;
-            return 0;
-        }
-
-        GLenum fmt = comp == 4 ? GL_RGBA : GL_RGB;
-        glBindTexture(GL_TEXTURE_2D, id);
-        glTexImage2D(GL_TEXTURE_2D, 0, fmt, w, h, 0, fmt, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-        return id;
-    }
 }
 
-void initWindows() {
+void initWindows(VertexLayout layout) {
 
     float windowVertices[] = {
         // Pozitie           // Normala        // TexCoord
@@ -83,34 +65,36 @@ void initWindows() {
         -1.0f,  0.7f, -9.8f,  0.0f, 0.0f, 1.0f,    0.0f, 1.0f,  // Top-left
     };
 
-    GLuint windowIndices[] = {
+    GLushort windowIndices[] = {
         0, 1, 2, 2, 3, 0,
         4, 5, 6, 6, 7, 4
     };
 
-    glGenVertexArrays(1, &windowVAO);
-    glGenBuffers(1, &windowVBO);
-    glGenBuffers(1, &windowEBO);
-
-    glBindVertexArray(windowVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, windowVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(windowVertices), windowVertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, windowEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(windowIndices), windowIndices, GL_STATIC_DRAW);
+    // Acelasi format ca restul geometriei din arena (cu tangente, eventual compact)
+    size_t windowVertexCount = sizeof(windowVertices) / (8 * sizeof(float));
+    vector<float> vertexData(windowVertexCount * VERTEX_FLOATS, 0.0f);
+    for (size_t v = 0; v < windowVertexCount; v++) {
+        copy(windowVertices + v * 8, windowVertices + (v + 1) * 8, vertexData.begin() + v * VERTEX_FLOATS);
+    }
+    vector<GLuint> indices(begin(windowIndices), end(windowIndices));
+    generateTangents(vertexData, indices);
+    // Modelul ferestrelor e identitatea, deci limitele sunt direct in spatiul lumii
+    for (int w = 0; w < WINDOW_COUNT; w++) {
+        windowBoundsData[w] = computeBounds(vertexData.data(), VERTEX_FLOATS, indices.data() + w * 6, 6);
+        windowPolygons[w].clear();
+        for (int v = w * 4; v < w * 4 + 4; v++) {
+            windowPolygons[w].push_back(glm::vec3(windowVertices[v * 8], windowVertices[v * 8 + 1], windowVertices[v * 8 + 2]));
+        }
+    }
 
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // TexCoord attribute
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    PositionDequantization dequantization;
+    vector<unsigned char> vertices = packVertices(vertexData.data(), vertexData.size() / VERTEX_FLOATS, layout, dequantization);
+    windowPositionTransform = dequantization.matrix();
+    vector<unsigned char> packedIndices = packIndices(indices.data(), indices.size(), GL_UNSIGNED_SHORT);
 
-    glBindVertexArray(0);
+    if (!allocateGeometry(layout, vertexData.size() / VERTEX_FLOATS, packedIndices.size(), windowGeometry)) return;
+    writeGeometryVertices((size_t)windowGeometry.baseVertex * vertexStride(layout), vertices.data(), vertices.size());
+    writeGeometryIndices(windowGeometry.firstIndexByte, packedIndices.data(), packedIndices.size());
 
     cout << "Windows geometry initialized successfully!" << endl;
 }
@@ -139,10 +123,16 @@ void initWindowShaders() {
     glDeleteShader(fs);
 }
 
+void prefetchWindowTextures() {
+    prefetchTexture("Textures/Window/frame.png");
+    prefetchTexture("Textures/Landscape/landscape1.jpg");
+    prefetchTexture("Textures/Landscape/landscape2.jpg");
+}
+
 void loadWindowTextures() {
-    windowFrameTex = loadTexture("Textures/Window/frame.png");
-    landscape1Tex = loadTexture("Textures/Landscape/landscape1.jpg");
-    landscape2Tex = loadTexture("Textures/Landscape/landscape2.jpg");
+    windowFrameTex = acquireTexture("Textures/Window/frame.png");
+    landscape1Tex = acquireTexture("Textures/Landscape/landscape1.jpg");
+    landscape2Tex = acquireTexture("Textures/Landscape/landscape2.jpg");
 
     if (windowFrameTex && landscape1Tex && landscape2Tex) {
         cout << "Window textures loaded successfully!" << endl;
@@ -154,7 +144,8 @@ void loadWindowTextures() {
 
 void drawWindows(const glm::mat4& projection, const glm::mat4& view,
     const glm::vec3& viewPos, float timeOfDay,
-    const glm::vec3& sunPosition, float sunIntensity) {
+    const glm::vec3& sunPosition, float sunIntensity, unsigned windowMask) {
+    if (!(windowMask & ALL_WINDOWS)) return;
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -162,11 +153,12 @@ void drawWindows(const glm::mat4& projection, const glm::mat4& view,
     glUseProgram(windowShaderProgram);
 
     glm::mat4 model = glm::mat4(1.0f);
-    glm::mat4 mvp = projection * view * model;
+    glm::mat4 vertexModel = model * windowPositionTransform;
+    glm::mat4 mvp = projection * view * vertexModel;
     glm::mat4 normalMatrix = glm::transpose(glm::inverse(model));
 
     glUniformMatrix4fv(glGetUniformLocation(windowShaderProgram, "mvpMatrix"), 1, GL_FALSE, glm::value_ptr(mvp));
-    glUniformMatrix4fv(glGetUniformLocation(windowShaderProgram, "modelMatrix"), 1, GL_FALSE, glm::value_ptr(model));
+    glUniformMatrix4fv(glGetUniformLocation(windowShaderProgram, "modelMatrix"), 1, GL_FALSE, glm::value_ptr(vertexModel));
     glUniformMatrix4fv(glGetUniformLocation(windowShaderProgram, "normalMatrix"), 1, GL_FALSE, glm::value_ptr(normalMatrix));
 
     glUniform3fv(glGetUniformLocation(windowShaderProgram, "viewPos"), 1, glm::value_ptr(viewPos));
@@ -174,8 +166,6 @@ void drawWindows(const glm::mat4& projection, const glm::mat4& view,
     glUniform3fv(glGetUniformLocation(windowShaderProgram, "sunPosition"), 1, glm::value_ptr(sunPosition));
     glUniform1f(glGetUniformLocation(windowShaderProgram, "sunIntensity"), sunIntensity);
 
-    glBindVertexArray(windowVAO);
-
     glUniform1i(glGetUniformLocation(windowShaderProgram, "windowFrame"), 0);
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, windowFrameTex);
@@ -184,25 +174,35 @@ void drawWindows(const glm::mat4& projection, const glm::mat4& view,
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, landscape1Tex);
 
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(0 * sizeof(GLuint)));
+    if (windowMask & 1) {
+        glDrawElementsBaseVertex(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (void*)(windowGeometry.firstIndexByte + 0 * sizeof(GLushort)),
+            windowGeometry.baseVertex);
+    }
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, landscape2Tex);
+    if (windowMask & 2) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, landscape2Tex);
 
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(6 * sizeof(GLuint)));
+        glDrawElementsBaseVertex(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (void*)(windowGeometry.firstIndexByte + 6 * sizeof(GLushort)),
+            windowGeometry.baseVertex);
+    }
 
-    glBindVertexArray(0);
     glDisable(GL_BLEND);
 }
 
+Bounds windowBounds(int window) {
+    return windowBoundsData[window];
+}
+
+const vector<glm::vec3>& windowPolygon(int window) {
+    return windowPolygons[window];
+}
+
 void cleanupWindows() {
-    glDeleteVertexArrays(1, &windowVAO);
-    glDeleteBuffers(1, &windowVBO);
-    glDeleteBuffers(1, &windowEBO);
     glDeleteProgram(windowShaderProgram);
-    glDeleteTextures(1, &windowFrameTex);
-    glDeleteTextures(1, &landscape1Tex);
-    glDeleteTextures(1, &landscape2Tex);
+    releaseTexture(windowFrameTex);
+    releaseTexture(landscape1Tex);
+    releaseTexture(landscape2Tex);
 
     cout << "Window resources cleaned up!" << endl;
 }
\ No newline at end of file
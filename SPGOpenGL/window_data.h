@@ -2,11 +2,21 @@
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include "vertex_format.h"
+#include "bounds.h"
+#include <vector>
 
-void initWindows();
+const int WINDOW_COUNT = 2;
+const unsigned ALL_WINDOWS = (1u << WINDOW_COUNT) - 1;
+
+// Geometria ferestrelor e pusa in arena comuna (geometry_arena.h), in formatul layout
+void initWindows(VertexLayout layout = VertexLayout::Float);
 
 void initWindowShaders();
 
+// Porneste decodarea in fundal (texture_loader.h); loadWindowTextures doar le urca
+void prefetchWindowTextures();
+
 void loadWindowTextures();
 
 void drawWindows(const glm::mat4& projection,
@@ -14,6 +24,13 @@ void drawWindows(const glm::mat4& projection,
     const glm::vec3& viewPos,
     float timeOfDay,
     const glm::vec3& sunPosition,
-    float sunIntensity);
+    float sunIntensity,
+    unsigned windowMask = ALL_WINDOWS); // bitul w = fereastra w e desenata
+
+// Limitele ferestrei w, in spatiul lumii
+Bounds windowBounds(int window);
+
+// Colturile ferestrei w in spatiul lumii, in ordine (poligonul portalului spre exterior)
+const std::vector<glm::vec3>& windowPolygon(int window);
 
 void cleanupWindows();
\ No newline at end of file